@@ -0,0 +1,117 @@
+#include "esphome/components/xy_light/async_frame_writer.h"
+
+#include <algorithm>
+#include <cinttypes>
+
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+
+using namespace esphome::xy_light;
+
+static const char *const TAG = "xy_light.async_writer";
+
+void AsyncFrameWriter::Mailbox::commit_frame(const XyFrame &frame) {
+  this->_writer->_counters.published++;
+  if (this->_pending) {
+    this->_writer->_counters.superseded++;
+    this->_frame.merge(frame);
+    return;
+  }
+
+  this->_frame = frame;
+  this->_pending = true;
+}
+
+void AsyncFrameWriter::Mailbox::write() {
+  this->_pending = false;
+  this->_target->commit_frame(this->_frame);
+  this->_frame.clear();
+  this->_writer->_counters.written++;
+}
+
+void AsyncFrameWriter::attach(const std::vector<XyOutput *> &outputs) {
+  this->_lights.push_back({this->_mailboxes.size(), outputs.size(), 0});
+  for (auto output : outputs) {
+    this->_mailboxes.push_back(std::unique_ptr<Mailbox>(new Mailbox(this, output->get_frame_sink())));
+    output->set_frame_sink(this->_mailboxes.back().get());
+  }
+}
+
+bool AsyncFrameWriter::pending() const {
+  for (auto &mailbox : this->_mailboxes) {
+    if (mailbox->pending())
+      return true;
+  }
+  return false;
+}
+
+void AsyncFrameWriter::loop() {
+  // Unspent budget builds up to the most any light needs, so a slow light is still written every few iterations
+  uint32_t limit = this->_write_budget_us;
+  for (auto &light : this->_lights) {
+    limit = std::max(limit, light.cost_us);
+  }
+  this->_credit_us = std::min(this->_credit_us + this->_write_budget_us, limit);
+
+  auto count = this->_lights.size();
+  bool written = false;
+  for (size_t n = 0; n < count; n++) {
+    auto index = (this->_next + n) % count;
+    auto &light = this->_lights[index];
+    if (!this->light_pending(light))
+      continue;
+    if (light.cost_us > this->_credit_us) {
+      // Out of budget, carry on from this light next iteration
+      this->_next = index;
+      this->_counters.budget_exceeded++;
+      break;
+    }
+
+    auto start = micros();
+    this->write_light(light);
+    light.cost_us = micros() - start;
+    this->_credit_us -= std::min(this->_credit_us, light.cost_us);
+    written = true;
+  }
+  if (written)
+    this->_counters.write_iterations++;
+
+  auto now = millis();
+  if (now - this->_last_stats_ms >= STATS_INTERVAL_MS && this->_counters.published != this->_reported_published) {
+    this->_last_stats_ms = now;
+    this->_reported_published = this->_counters.published;
+    ESP_LOGD(TAG, "%" PRIu32 " frames published, %" PRIu32 " written, %" PRIu32 " superseded",
+             this->_counters.published, this->_counters.written, this->_counters.superseded);
+  }
+}
+
+bool AsyncFrameWriter::light_pending(const LightMailboxes &light) const {
+  for (size_t i = light.start; i < light.start + light.count; i++) {
+    if (this->_mailboxes[i]->pending())
+      return true;
+  }
+  return false;
+}
+
+void AsyncFrameWriter::write_light(const LightMailboxes &light) {
+  // All of a light's frames are written in the same iteration, then latched together
+  for (size_t i = light.start; i < light.start + light.count; i++) {
+    if (this->_mailboxes[i]->pending())
+      this->_mailboxes[i]->write();
+  }
+
+  for (size_t i = light.start; i < light.start + light.count; i++) {
+    auto *target = this->_mailboxes[i]->target();
+    size_t j = light.start;
+    while (j < i && this->_mailboxes[j]->target() != target)
+      j++;
+    if (j == i)
+      target->latch();
+  }
+}
+
+void AsyncFrameWriter::dump_config() {
+  ESP_LOGCONFIG(TAG, "XY Light Async Frame Writer:");
+  ESP_LOGCONFIG(TAG, "  Lights: %u, outputs: %u", (unsigned) this->_lights.size(), (unsigned) this->_mailboxes.size());
+  ESP_LOGCONFIG(TAG, "  Write budget: %" PRIu32 " us", this->_write_budget_us);
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include <memory>
+#include <stdint.h>
+#include <vector>
+
+#include "esphome/core/component.h"
+#include "esphome/components/xy_light/xy_output.h"
+
+namespace esphome {
+namespace xy_light {
+
+struct AsyncWriterCounters {
+  // Frames committed by the outputs, and those actually written to their sinks
+  uint32_t published = 0;
+  uint32_t written = 0;
+  // Frames folded into a newer one before they were written
+  uint32_t superseded = 0;
+  // Loop iterations which ran out of write budget with frames still pending
+  uint32_t budget_exceeded = 0;
+  // Loop iterations which wrote at least one frame
+  uint32_t write_iterations = 0;
+};
+
+// Decouples a light's outputs from slow sinks (ie PWM expanders on I2C). Each output commits its frames to a single
+// slot mailbox, where a newer frame replaces the levels of one which has not been written yet, and loop() writes the
+// pending mailboxes within a time budget. Mailboxes are written a light at a time, so its outputs still change
+// together. Rendering never waits on the bus, and when the bus can not keep up with a transition the intermediate
+// frames are dropped rather than queued.
+//
+// The budget is carried over between iterations: each iteration adds to it, and a light is only written once it
+// covers the time the light's last write took. A light which takes longer to write than one iteration's budget is
+// then written every few iterations, so its bus time is spread over the iterations in between.
+class AsyncFrameWriter : public Component {
+ public:
+  static const uint32_t STATS_INTERVAL_MS = 60000;
+
+  // Routes each output of a light through a mailbox, before any frames are rendered
+  void attach(const std::vector<XyOutput *> &outputs);
+
+  // Time spent writing frames per loop iteration, on average
+  void set_write_budget(uint32_t us) { this->_write_budget_us = us; }
+
+  const AsyncWriterCounters &counters() const { return this->_counters; }
+  bool pending() const;
+
+  void loop() override;
+  void dump_config() override;
+
+  // After the lights, so their frames are written in the iteration they are rendered
+  float get_setup_priority() const override { return setup_priority::LATE - 1.0f; }
+
+ protected:
+  class Mailbox : public XyFrameSink {
+   public:
+    Mailbox(AsyncFrameWriter *writer, XyFrameSink *target) : _writer(writer), _target(target) {}
+
+    void commit_frame(const XyFrame &frame) override;
+
+    bool pending() const { return this->_pending; }
+    XyFrameSink *target() const { return this->_target; }
+    void write();
+
+   protected:
+    AsyncFrameWriter *_writer;
+    XyFrameSink *_target;
+    XyFrame _frame;
+    bool _pending = false;
+  };
+
+  // Mailboxes of each light, in the order they were attached
+  struct LightMailboxes {
+    size_t start;
+    size_t count;
+    // Time the light's last write took, which the budget has to cover before it is written again
+    uint32_t cost_us;
+  };
+
+  std::vector<std::unique_ptr<Mailbox>> _mailboxes;
+  std::vector<LightMailboxes> _lights;
+  // Light to write first next iteration, so a busy bus still serves every light in turn
+  size_t _next = 0;
+  uint32_t _write_budget_us = 2000;
+  // Budget carried over from earlier iterations, up to what the most costly light needs
+  uint32_t _credit_us = 0;
+
+  AsyncWriterCounters _counters;
+  uint32_t _last_stats_ms = 0;
+  uint32_t _reported_published = 0;
+
+  bool light_pending(const LightMailboxes &light) const;
+  void write_light(const LightMailboxes &light);
+};
+
+}  // namespace xy_light
+}  // namespace esphome
@@ -0,0 +1,35 @@
+#include "esphome/components/xy_light/calibration_telemetry.h"
+
+#include <cinttypes>
+
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+
+using namespace esphome::xy_light;
+
+static const char *const TAG = "xy_light.calibration";
+
+void CalibrationTelemetry::loop() {
+  auto now = millis();
+  if (now - this->_last_flush < FLUSH_INTERVAL_MS)
+    return;
+  this->_last_flush = now;
+
+  for (uint8_t n = 0; n < SAMPLES_PER_FLUSH; n++) {
+    auto tail = this->_tail.load(std::memory_order_relaxed);
+    if (tail == this->_head.load(std::memory_order_acquire))
+      break;
+
+    auto &sample = this->_samples[tail];
+    sample.format(sample.values);
+    this->_tail.store((uint8_t) ((tail + 1) % CAPACITY), std::memory_order_release);
+  }
+
+  auto dropped = this->dropped();
+  if (dropped != this->_reported_dropped && now - this->_last_dropped_report >= DROPPED_REPORT_INTERVAL_MS) {
+    this->_last_dropped_report = now;
+    ESP_LOGW(TAG, "%" PRIu32 " calibration samples dropped (%" PRIu32 " in total)", dropped - this->_reported_dropped,
+             dropped);
+    this->_reported_dropped = dropped;
+  }
+}
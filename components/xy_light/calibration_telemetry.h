@@ -0,0 +1,72 @@
+#pragma once
+#include <atomic>
+#include <initializer_list>
+#include <stdint.h>
+
+#include "esphome/core/component.h"
+
+namespace esphome {
+namespace xy_light {
+
+// Logs a sample's values, in the format of whichever light or output pushed it
+using CalibrationFormatter = void (*)(const float *values);
+
+struct CalibrationSample {
+  static const uint8_t MAX_VALUES = 5;
+
+  CalibrationFormatter format;
+  float values[MAX_VALUES];
+};
+
+// Calibration data of every light and output, pushed from the apply path and logged from loop() at a limited rate.
+// Pushing is a copy into a single producer / single consumer ring, so calibration logging can stay on during
+// transitions. Samples pushed while the ring is full are dropped and counted.
+class CalibrationTelemetry : public Component {
+ public:
+  static const uint8_t CAPACITY = 32;
+  static const uint32_t FLUSH_INTERVAL_MS = 100;
+  static const uint8_t SAMPLES_PER_FLUSH = 4;
+  static const uint32_t DROPPED_REPORT_INTERVAL_MS = 1000;
+
+  static CalibrationTelemetry *instance() {
+    static CalibrationTelemetry telemetry;
+    return &telemetry;
+  }
+
+  void push(CalibrationFormatter format, std::initializer_list<float> values) {
+    auto head = this->_head.load(std::memory_order_relaxed);
+    auto next = (uint8_t) ((head + 1) % CAPACITY);
+    if (next == this->_tail.load(std::memory_order_acquire)) {
+      this->_dropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+
+    auto &sample = this->_samples[head];
+    sample.format = format;
+    uint8_t i = 0;
+    for (auto v : values) {
+      if (i < CalibrationSample::MAX_VALUES)
+        sample.values[i++] = v;
+    }
+    this->_head.store(next, std::memory_order_release);
+  }
+
+  uint32_t dropped() const { return this->_dropped.load(std::memory_order_relaxed); }
+
+  void loop() override;
+
+  float get_setup_priority() const override { return setup_priority::DATA; }
+
+ protected:
+  CalibrationSample _samples[CAPACITY];
+  std::atomic<uint8_t> _head{0};
+  std::atomic<uint8_t> _tail{0};
+  std::atomic<uint32_t> _dropped{0};
+
+  uint32_t _last_flush = 0;
+  uint32_t _last_dropped_report = 0;
+  uint32_t _reported_dropped = 0;
+};
+
+}  // namespace xy_light
+}  // namespace esphome
@@ -507,3 +507,59 @@ def wavelength_to_xy(wavelength):
     y_chromaticity = y / xy_sum
 
     return [x_chromaticity, y_chromaticity]
+
+
+# White points of the standard profiles, these mirror Cie2dColorSpace in color_spaces.h
+ILLUMINANT_D55 = [0.33242, 0.34743]
+ILLUMINANT_D65 = [0.31271, 0.32902]
+
+
+def mired_to_xy(mired):
+    # Krystek's approximation of the planckian locus, re-parameterised in mired as in planckian_locus.h
+    m = float(mired)
+    u = (0.860117757 * m * m + 154.118254 * m + 128641.212) / (m * m + 842.420235 * m + 708145.163)
+    v = (0.317398726 * m * m + 42.2806245 * m + 42048.1691) / (m * m - 28.9741816 * m + 161456.053)
+
+    # CIE 1960 uv -> CIE 1931 xy
+    denom = 2.0 * u - 8.0 * v + 4.0
+    return [3.0 * u / denom, 2.0 * v / denom]
+
+
+def xy_to_XYZ(xy, Y=1.0):
+    [x, y] = xy
+    return [x * Y / y, Y, (1.0 - x - y) * Y / y]
+
+
+def matrix3x3_inverse(m):
+    det = (m[0][0] * m[1][1] * m[2][2] + m[0][1] * m[1][2] * m[2][0] + m[0][2] * m[1][0] * m[2][1]) - \
+          (m[2][0] * m[1][1] * m[0][2] + m[2][1] * m[1][2] * m[0][0] + m[2][2] * m[1][0] * m[0][1])
+
+    return [
+        [(m[1][1] * m[2][2] - m[2][1] * m[1][2]) / det,
+         (m[0][2] * m[2][1] - m[0][1] * m[2][2]) / det,
+         (m[0][1] * m[1][2] - m[0][2] * m[1][1]) / det],
+        [(m[1][2] * m[2][0] - m[1][0] * m[2][2]) / det,
+         (m[0][0] * m[2][2] - m[0][2] * m[2][0]) / det,
+         (m[1][0] * m[0][2] - m[0][0] * m[1][2]) / det],
+        [(m[1][0] * m[2][1] - m[2][0] * m[1][1]) / det,
+         (m[2][0] * m[0][1] - m[0][0] * m[2][1]) / det,
+         (m[0][0] * m[1][1] - m[1][0] * m[0][1]) / det]
+    ]
+
+
+def rgb_transform_matrices(r_xy, g_xy, b_xy, w_xy):
+    """ Linear RGB -> XYZ and XYZ -> linear RGB matrices for the given primaries and white point,
+        computed the same way as RgbChromaTransform but in double precision.
+        Returns ([RGB2XYZ row major], [XYZ2RGB row major]) """
+
+    # For each primary, get the "missing" z (where x+y+z = 1, so z = 1-x-y)
+    d = [[p[0], p[1], 1.0 - p[0] - p[1]] for p in [r_xy, g_xy, b_xy]]
+    inv_d = matrix3x3_inverse(d)
+
+    # Scale each primary so that RGB (1, 1, 1) maps onto the white point
+    w_XYZ = xy_to_XYZ(w_xy)
+    wp_scale = [sum(w_XYZ[k] * inv_d[k][j] for k in range(3)) for j in range(3)]
+
+    RGB2XYZ = [[d[j][i] * wp_scale[j] for j in range(3)] for i in range(3)]
+    XYZ2RGB = [[inv_d[j][i] / wp_scale[i] for j in range(3)] for i in range(3)]
+    return (RGB2XYZ, XYZ2RGB)
@@ -1,10 +1,10 @@
 #include <cmath>
-#include <vector>
 
 #include "esphome/core/log.h"
 #include "esphome/components/xy_light/color_spaces.h"
 
 using namespace esphome::xy_light::color_space;
+namespace fixed_point = esphome::xy_light::fixed_point;
 
 xyY_Cie1931 XYZ_Cie1931::as_xyY_cie1931() {
   float sum = this->X + this->Y + this->Z; 
@@ -17,6 +17,34 @@ Xy_Cie1931 XYZ_Cie1931::as_xy_cie1931() {
   return Xy_Cie1931(xyY.x, xyY.y);
 }
 
+namespace {
+float lab_f(float t) { return t > 0.008856f ? cbrtf(t) : (7.787f * t) + (16.0f / 116.0f); }
+}  // namespace
+
+float XYZ_Cie1931::delta_e(const XYZ_Cie1931 &other, const XYZ_Cie1931 &white) const {
+  auto fx0 = lab_f(this->X / white.X), fy0 = lab_f(this->Y / white.Y), fz0 = lab_f(this->Z / white.Z);
+  auto fx1 = lab_f(other.X / white.X), fy1 = lab_f(other.Y / white.Y), fz1 = lab_f(other.Z / white.Z);
+
+  auto dL = 116.0f * (fy0 - fy1);
+  auto da = 500.0f * ((fx0 - fy0) - (fx1 - fy1));
+  auto db = 200.0f * ((fy0 - fz0) - (fy1 - fz1));
+  return sqrtf((dL * dL) + (da * da) + (db * db));
+}
+
+Luv_Cie1976 XYZ_Cie1931::as_Luv_cie1976(const XYZ_Cie1931 &white) const {
+  auto dn = white.X + (15.0f * white.Y) + (3.0f * white.Z);
+  auto d = this->X + (15.0f * this->Y) + (3.0f * this->Z);
+  if (this->Y <= 0.0f || white.Y <= 0.0f || d <= 0.0f || dn <= 0.0f)
+    return Luv_Cie1976();
+
+  auto un = (4.0f * white.X) / dn, vn = (9.0f * white.Y) / dn;
+
+  auto Yr = this->Y / white.Y;
+  auto L = Yr > 0.008856f ? (116.0f * cbrtf(Yr)) - 16.0f : 903.3f * Yr;
+  auto u = (4.0f * this->X) / d, v = (9.0f * this->Y) / d;
+  return Luv_Cie1976(L, 13.0f * L * (u - un), 13.0f * L * (v - vn));
+}
+
 float xyY_Cie1931::cct_kelvin_approx() { return Xy_Cie1931(this->x, this->y).cct_kelvin_approx(); }
 
 float xyY_Cie1931::cct_mired_approx() { return Xy_Cie1931(this->x, this->y).cct_mired_approx(); }
@@ -115,78 +143,46 @@ float Uv_Cie1960::tint_impurity(float green_tint_duv_impurity, float purple_tint
                  : clamp((purple_tint_duv_impurity + duv) / purple_tint_duv_impurity, 0.0f, 1.0f);
 }
 
-bool Uv_Cie1960::has_duv() {
+float Uv_Cie1960::tint_impurity(CctDuv cct_duv, float green_tint_duv_impurity, float purple_tint_duv_impurity) {
+  // Values outside of the valid region do not have a meaningful delta uv
+  if (!cct_duv.valid) {
+    return 0.0f;
+  }
+
+  auto duv = cct_duv.duv;
+  return duv > 0 ? clamp((green_tint_duv_impurity - duv) / green_tint_duv_impurity, 0.0f, 1.0f)
+                 : clamp((purple_tint_duv_impurity + duv) / purple_tint_duv_impurity, 0.0f, 1.0f);
+}
+
+namespace {
+// Generated at compile time, so needs no allocation and is safe to read from any thread
+constexpr planckian_locus::DuvRegion DUV_REGION = planckian_locus::generate_duv_region();
+}  // namespace
+
+bool Uv_Cie1960::has_duv() const {
   // XY values which lay outside beyond the intersection of iso-temperatures line (for example Green hues)
   // do not have a undefined delta UV, and can result in incorrect delta UV, values when approximated.
   // We can filter for these values using by testing for values which lay within a known polygon of valid values.
   // This method is fairly crude and could probably be improved, but it works.
-  auto &vert = *this->duv_quadrants();
-
-  int nvert = vert.size();
-
-  // take the last item for first iteration to complete the "loop"
-  int j = nvert - 1;
-
   bool c = false;
   auto u = this->u;
   auto v = this->v;
 
-  for (int i = 0; i < nvert; j = i++) {
-    if (((vert[i].v >= v) != (vert[j].v >= v)) &&
-        (u <= (vert[j].u - vert[i].u) * (v - vert[i].v) / (vert[j].v - vert[i].v) + vert[i].u)) {
-      c = !c;
-    }
+  for (auto &e : DUV_REGION.edges) {
+    // Non short-circuiting, as the slope is precomputed both sides are cheap
+    c ^= ((e.a_v >= v) != (e.b_v >= v)) & (u <= (e.du_dv * (v - e.a_v)) + e.a_u);
   }
 
   return c;
 }
 
-std::vector<Cct> Uv_Cie1960::quadrants() {
-  return {
-      Cct::from_kelvin(1000),  Cct::from_kelvin(1600), Cct::from_kelvin(2000),  Cct::from_kelvin(2500),
-      Cct::from_kelvin(3000),  Cct::from_kelvin(4000), Cct::from_kelvin(5000),  Cct::from_kelvin(6000),
-      Cct::from_kelvin(7000),  Cct::from_kelvin(8000), Cct::from_kelvin(10000), Cct::from_kelvin(15000),
-      Cct::from_kelvin(20000),
-  };
-}
-
-const std::vector<Uv_Cie1960> *Uv_Cie1960::duv_quadrants() {
-  static std::vector<Uv_Cie1960> duv_area;
-  if (!duv_area.empty())
-    return &duv_area;
-
-  float duv_area_limit = 0.09f;
-  std::vector<Uv_Cie1960> green_duv;
-  std::vector<Uv_Cie1960> purple_duv;
-
-  auto bins = this->quadrants();
-  for (auto cct : bins) {
-    auto max_green_tint = cct.delta_uv_cie1960(duv_area_limit);
-    auto max_purple_tint = cct.delta_uv_cie1960(-duv_area_limit);
-
-    green_duv.push_back(max_green_tint);
-    purple_duv.push_back(max_purple_tint);
-  }
-  duv_area = green_duv;
-  duv_area.insert(duv_area.end(), purple_duv.rbegin(), purple_duv.rend());
-  return &duv_area;
-}
-
 Uv_Cie1960 Cct::delta_uv_cie1960(float delta_uv) {
   // https://pdfslide.net/documents/practical-use-and-calculation-of-cct-and-duv.html?page=5
   if (this->calc_theta) {
-    auto t0_uv = this->uv;
-    auto t1_uv = Cct::from_kelvin(this->kelvin + 0.1f).uv;
-
-    auto du = (double) (t0_uv.u - t1_uv.u);
-    auto dv = (double) (t0_uv.v - t1_uv.v);
-
-    auto du2 = du * du;
-    auto dv2 = dv * dv;
-    auto l = sqrt(du2 + dv2);
-
-    this->cos_t = du / l;
-    this->sin_t = dv / l;
+    // Tangent is precomputed in the locus table, so no need to evaluate a second locus point
+    auto p = PlanckianLocus::at_kelvin(this->kelvin);
+    this->cos_t = p.tangent_u;
+    this->sin_t = p.tangent_v;
     this->calc_theta = false;
   }
 
@@ -200,19 +196,94 @@ Xy_Cie1931 Uv_Cie1976::as_xy_cie1931() {
   return Xy_Cie1931((9.0f * this->u) / denom, (4.0f * this->v) / denom);
 }
 
-Cct Cct::from_mireds(float m) { return Cct::from_kelvin(1000000.0f / m); }
+Cct Cct::from_mireds(float m) { return Cct(1000000.0f / m, PlanckianLocus::at_mired(m)); }
+
+Cct Cct::from_kelvin(float k) { return Cct(k, PlanckianLocus::at_kelvin(k)); }
+
+RGBIntensityCalibrationFixed::RGBIntensityCalibrationFixed(const RGBIntensityCalibration &cal)
+    : int_output_cal(fixed_point::Vec3::from_float(cal.r_int_output_cal, cal.g_int_output_cal, cal.b_int_output_cal)),
+      min_output_cal(fixed_point::Vec3::from_float(cal.r_min_output_cal, cal.g_min_output_cal, cal.b_min_output_cal)),
+      range_output_cal(fixed_point::Vec3::from_float((1.0f - cal.r_min_output_cal) * cal.r_max_output_cal,
+                                                     (1.0f - cal.g_min_output_cal) * cal.g_max_output_cal,
+                                                     (1.0f - cal.b_min_output_cal) * cal.b_max_output_cal)),
+      r_gamma_compress(cal.r_gamma_compress),
+      g_gamma_compress(cal.g_gamma_compress),
+      b_gamma_compress(cal.b_gamma_compress) {}
+
+fixed_point::Vec3 RGBIntensityCalibrationFixed::apply_calibration(fixed_point::Vec3 rgb) const {
+  using namespace fixed_point;
+
+  // Weighted outputs, see RGBIntensityCalibration::adjust_for_weighted_outputs()
+  auto l = mul(rgb.x + rgb.y + rgb.z, ONE / 3);
+  auto adj = rgb * this->int_output_cal;
+  auto max = adj.max();
+  if (max <= 0) {
+    // The float path ends up with NaN or negative values here, both of which are clamped to off
+    return Vec3();
+  }
+  rgb = Vec3(mul_div(adj.x, l, max), mul_div(adj.y, l, max), mul_div(adj.z, l, max));
+
+  // Colors out of gamut
+  max = rgb.max();
+  if (max > ONE) {
+    rgb = Vec3(div(rgb.x, max), div(rgb.y, max), div(rgb.z, max));
+  }
+
+  // Gamma
+  rgb = Vec3(this->r_gamma_compress.eval_fixed(rgb.x), this->g_gamma_compress.eval_fixed(rgb.y),
+             this->b_gamma_compress.eval_fixed(rgb.z));
+
+  // Hardware min / max intensity
+  rgb.x = rgb.x <= 0 ? 0 : mul(rgb.x, this->range_output_cal.x) + this->min_output_cal.x;
+  rgb.y = rgb.y <= 0 ? 0 : mul(rgb.y, this->range_output_cal.y) + this->min_output_cal.y;
+  rgb.z = rgb.z <= 0 ? 0 : mul(rgb.z, this->range_output_cal.z) + this->min_output_cal.z;
+  return rgb;
+}
+
+CwWwIntensityCalibrationFixed::CwWwIntensityCalibrationFixed(const CwWwIntensityCalibration &cal)
+    : max_cw(fixed_point::from_float(cal.max_cw)),
+      max_ww(fixed_point::from_float(cal.max_ww)),
+      max_combined(fixed_point::from_float(cal.max_combined)),
+      min_cw(fixed_point::from_float(cal.min_cw)),
+      min_ww(fixed_point::from_float(cal.min_ww)),
+      min_combined(fixed_point::from_float(cal.min_combined)) {}
+
+fixed_point::Vec2 CwWwIntensityCalibrationFixed::apply_calibration(fixed_point::Vec2 in) const {
+  using namespace fixed_point;
+
+  auto total = in.x + in.y;
+  if (total <= 0) {
+    return Vec2();
+  }
+
+  auto cw = in.x;
+  auto ww = in.y;
+  auto max = in.max();
+  if (max > ONE) {
+    cw = div(cw, max);
+    ww = div(ww, max);
+  }
 
-Cct Cct::from_kelvin(float k) {
-  // Krystek, M. (1985). An algorithm to calculate correlated colour
-  //        temperature. Color Research & Application, 10(1), 38–40.
-  //        doi:10.1002/col.5080100109
-  double t = k;
-  double t2 = t * t;
-  auto u = (0.860117757 + (0.000154118254 * t) + (0.000000128641212 * t2)) /
-           (1.0 + (0.000842420235 * t) + (0.000000708145163 * t2));
+  // Blend between the single channel and combined calibration, see CwWwIntensityCalibration::apply_calibration()
+  auto blend = [](fixed_t lv, fixed_t single, fixed_t combined) {
+    if (lv <= ONE / 2) {
+      auto ratio = lv * 2;
+      return mul(single, ONE - ratio) + mul(combined, ratio);
+    }
+    auto ratio = (lv - (ONE / 2)) * 2;
+    return mul(single, ratio) + mul(combined, ONE - ratio);
+  };
 
-  auto v = (0.317398726 + (0.0000422806245 * t) + (0.0000000420481691 * t2)) /
-           (1.0 - (0.0000289741816 * t) + (0.000000161456053 * t2));
+  auto calibrate = [&](fixed_t v, fixed_t lv, fixed_t max_single, fixed_t min_single) -> fixed_t {
+    if (lv <= 0) {
+      // Zero means zero
+      return 0;
+    }
+    auto max_lv = blend(lv, max_single, this->max_combined);
+    auto min_lv = blend(lv, min_single, this->min_combined);
+    return mul(mul(v, ONE - min_lv), max_lv) + min_lv;
+  };
 
-  return Cct(k, Uv_Cie1960(float(u), float(v)));
+  return Vec2(calibrate(cw, div(in.x, total), this->max_cw, this->min_cw),
+              calibrate(ww, div(in.y, total), this->max_ww, this->min_ww));
 }
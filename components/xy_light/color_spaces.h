@@ -1,53 +1,24 @@
 #pragma once
 #include "esphome/core/optional.h"
 #include "esphome/core/helpers.h"
+#include "esphome/components/xy_light/fixed_point.h"
+#include "esphome/components/xy_light/planckian_locus.h"
+#include "esphome/components/xy_light/transfer_function.h"
 
 #include <math.h>
-#include <vector>
 
 namespace esphome {
 namespace xy_light {
 namespace color_space {
 
 struct Uv_Cie1976;
+struct Luv_Cie1976;
 struct Uv_Cie1960;
 struct xyY_Cie1931;
 struct Xy_Cie1931;
 struct Cct;
 struct RGB;
 
-static float exp_gamma_compress(float linear, float gamma) {
-  if (linear <= 0.0f)
-    return 0.0f;
-  if (gamma == 1.0f || gamma <= 0.0f)
-    return linear;
-  return powf(linear, 1.0f / gamma);
-}
-
-static float exp_gamma_decompress(float value, float gamma) {
-  if (value <= 0.0f)
-    return 0.0f;
-  if (gamma == 1.0f || gamma <= 0.0f)
-    return value;
-
-  return powf(value, gamma);
-}
-
-static float srgb_gamma_compress(float linear, float gamma) {
-    if (linear <= 0.0031308f) {
-        return 12.92 * linear;
-    } else {
-        return 1.055 * powf(linear, 1.0f / gamma) - 0.055f;
-    }
-}
-static float srgb_gamma_decompress(float sRGB, float gamma) {
-    if (sRGB <= 0.04045f) {
-        return sRGB / 12.92f;
-    } else {
-        return powf((sRGB + 0.055f) / 1.055f, gamma);
-    }
-}
-
 static float clamp_output_value(float v) {
   if(isnan(v)) {
     return 0.0f;
@@ -65,6 +36,10 @@ struct RGB {
   RGB() : r(0.0), g(0.0), b(0.0){};
   RGB(float r, float g, float b) : r(r), g(g), b(b){};
 
+  static RGB from_fixed(const fixed_point::Vec3 &rgb) {
+    return RGB(fixed_point::to_float(rgb.x), fixed_point::to_float(rgb.y), fixed_point::to_float(rgb.z));
+  }
+
   float max() { return std::max(std::max(this->r, this->g), this->b); }
 
   
@@ -88,6 +63,10 @@ struct RGB {
   RGB adjust_brightness(float i) {
     return RGB(this->r * i, this->g * i, this->b * i);
   }
+
+  RGB apply(const TransferFunction &fn) {
+    return RGB(fn(this->r), fn(this->g), fn(this->b));
+  }
 };
 
 struct RGBIntensityCalibration {
@@ -108,6 +87,25 @@ struct RGBIntensityCalibration {
   float g_gamma = 1.0; // value of 1 indicates no gamma correction is applied
   float b_gamma = 1.0; // value of 1 indicates no gamma correction is applied
 
+  TransferFunction r_gamma_compress = TransferFunction::exp_gamma_compress(1.0f);
+  TransferFunction g_gamma_compress = TransferFunction::exp_gamma_compress(1.0f);
+  TransferFunction b_gamma_compress = TransferFunction::exp_gamma_compress(1.0f);
+
+  void set_r_gamma(float g) {
+    this->r_gamma = g;
+    this->r_gamma_compress = TransferFunction::exp_gamma_compress(g);
+  }
+
+  void set_g_gamma(float g) {
+    this->g_gamma = g;
+    this->g_gamma_compress = TransferFunction::exp_gamma_compress(g);
+  }
+
+  void set_b_gamma(float g) {
+    this->b_gamma = g;
+    this->b_gamma_compress = TransferFunction::exp_gamma_compress(g);
+  }
+
   RGB apply_calibration(RGB rgb) {
     this->adjust_for_weighted_outputs(rgb);
     this->adjust_for_colors_out_of_gamut(rgb);
@@ -158,13 +156,30 @@ struct RGBIntensityCalibration {
   }
 
   void adjust_for_gamma_correction(RGB &rgb) {
-    rgb.r = exp_gamma_compress(rgb.r, r_gamma);
-    rgb.g = exp_gamma_compress(rgb.g, g_gamma);
-    rgb.b = exp_gamma_compress(rgb.b, b_gamma);
-    
+    rgb.r = this->r_gamma_compress(rgb.r);
+    rgb.g = this->g_gamma_compress(rgb.g);
+    rgb.b = this->b_gamma_compress(rgb.b);
   }
 };
 
+// Integer counterpart of RGBIntensityCalibration, for the fixed point pipeline.
+// Built from the float calibration once, when the profile is first used.
+struct RGBIntensityCalibrationFixed {
+  fixed_point::Vec3 int_output_cal;
+  fixed_point::Vec3 min_output_cal;
+  // (1 - min) * max, so applying the min / max calibration is a single multiply and add
+  fixed_point::Vec3 range_output_cal;
+
+  TransferFunction r_gamma_compress;
+  TransferFunction g_gamma_compress;
+  TransferFunction b_gamma_compress;
+
+  RGBIntensityCalibrationFixed() {}
+  explicit RGBIntensityCalibrationFixed(const RGBIntensityCalibration &cal);
+
+  fixed_point::Vec3 apply_calibration(fixed_point::Vec3 rgb) const;
+};
+
 struct CwWw {
   float cw;
   float ww;
@@ -172,14 +187,19 @@ struct CwWw {
   CwWw() : cw(0.0), ww(0.0){};
   CwWw(float cw, float ww) : cw(cw), ww(ww){};
 
+  // x is cold white, y is warm white
+  static CwWw from_fixed(const fixed_point::Vec2 &cwww) {
+    return CwWw(fixed_point::to_float(cwww.x), fixed_point::to_float(cwww.y));
+  }
+
   float max() { return std::max(this->cw, this->ww); }
 
-  CwWw gamma_compress(float gamma) {
-    return CwWw(exp_gamma_compress(this->cw, gamma), exp_gamma_compress(this->ww, gamma));
+  CwWw gamma_compress(const TransferFunction &fn) {
+    return CwWw(fn(this->cw), fn(this->ww));
   }
 
-  CwWw gamma_decompress(float gamma) {
-    return CwWw(exp_gamma_decompress(this->cw, gamma), exp_gamma_decompress(this->ww, gamma));
+  CwWw gamma_decompress(const TransferFunction &fn) {
+    return CwWw(fn(this->cw), fn(this->ww));
   }
 
   CwWw clamp_truncate() {
@@ -255,6 +275,23 @@ struct CwWwIntensityCalibration {
   }
 };
 
+// Integer counterpart of CwWwIntensityCalibration, for the fixed point pipeline.
+struct CwWwIntensityCalibrationFixed {
+  fixed_point::fixed_t max_cw = fixed_point::ONE;
+  fixed_point::fixed_t max_ww = fixed_point::ONE;
+  fixed_point::fixed_t max_combined = fixed_point::ONE;
+
+  fixed_point::fixed_t min_cw = 0;
+  fixed_point::fixed_t min_ww = 0;
+  fixed_point::fixed_t min_combined = 0;
+
+  CwWwIntensityCalibrationFixed() {}
+  explicit CwWwIntensityCalibrationFixed(const CwWwIntensityCalibration &cal);
+
+  // x is cold white, y is warm white
+  fixed_point::Vec2 apply_calibration(fixed_point::Vec2 in) const;
+};
+
 struct XYZ_Cie1931 {
   float X;
   float Y;
@@ -263,8 +300,18 @@ struct XYZ_Cie1931 {
   XYZ_Cie1931() : X(0.0), Y(0.0), Z(0.0){};
   XYZ_Cie1931(float X, float Y, float Z) : X(X), Y(Y), Z(Z){};
 
+  static XYZ_Cie1931 from_fixed(const fixed_point::Vec3 &XYZ) {
+    return XYZ_Cie1931(fixed_point::to_float(XYZ.x), fixed_point::to_float(XYZ.y), fixed_point::to_float(XYZ.z));
+  }
+
   xyY_Cie1931 as_xyY_cie1931();
   Xy_Cie1931 as_xy_cie1931();
+
+  // CIE76 colour difference, via CIELAB relative to the given white
+  float delta_e(const XYZ_Cie1931 &other, const XYZ_Cie1931 &white) const;
+
+  // Relative to the given reference white, whose luminance is L* = 100
+  Luv_Cie1976 as_Luv_cie1976(const XYZ_Cie1931 &white) const;
 };
 
 struct xyY_Cie1931 {
@@ -314,10 +361,13 @@ struct Uv_Cie1960 {
   float duv_approx();
   float tint_impurity(float green_tint_duv_impurity, float purple_tint_duv_impurity);
 
+  // Single pass, table driven CCT + Duv. Prefer this over separate cct/duv approximations in the hot path
+  CctDuv cct_duv() { return PlanckianLocus::solve(this->u, this->v); }
+
+  static float tint_impurity(CctDuv cct_duv, float green_tint_duv_impurity, float purple_tint_duv_impurity);
+
  private:
-  bool has_duv();
-  std::vector<Cct> quadrants();
-  const std::vector<Uv_Cie1960> *duv_quadrants();
+  bool has_duv() const;
 };
 
 struct Uv_Cie1976 {
@@ -331,11 +381,31 @@ struct Uv_Cie1976 {
   Uv_Cie1960 as_uv_cie1960();
 };
 
+// CIELUV relative to a reference white (ie the light's white at full brightness). Cheaper than CIELAB, as it is
+// one cube root from XYZ, so used to tell whether two frames of a transition can be told apart.
+struct Luv_Cie1976 {
+  float L;
+  float u;
+  float v;
+
+  Luv_Cie1976() : L(0.0), u(0.0), v(0.0){};
+  Luv_Cie1976(float L, float u, float v) : L(L), u(u), v(v){};
+
+  // Squared CIE76 colour difference (delta E*uv), to compare against a squared threshold without a square root
+  float delta_e_squared(const Luv_Cie1976 &other) const {
+    auto dL = this->L - other.L, du = this->u - other.u, dv = this->v - other.v;
+    return (dL * dL) + (du * du) + (dv * dv);
+  }
+};
+
 class Cct {
   float sin_t;
   float cos_t;
   bool calc_theta = true;
 
+  Cct(float kelvin, const LocusPoint &p)
+      : sin_t(p.tangent_v), cos_t(p.tangent_u), calc_theta(false), uv(p.u, p.v), kelvin(kelvin){};
+
  public:
   Uv_Cie1960 uv;
 
@@ -0,0 +1,121 @@
+#include "esphome/components/xy_light/command_trace.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <math.h>
+
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+
+using namespace esphome::xy_light;
+
+static const char *const TAG = "xy_light.trace";
+
+static void put_u16(uint8_t *p, uint16_t v) {
+  p[0] = (uint8_t) v;
+  p[1] = (uint8_t) (v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v) {
+  put_u16(p, (uint16_t) v);
+  put_u16(p + 2, (uint16_t) (v >> 16));
+}
+
+static uint32_t quantize(float v, float scale, uint32_t max) {
+  if (!(v > 0.0f))
+    return 0;
+  auto q = lroundf(v * scale);
+  return q >= (long) max ? max : (uint32_t) q;
+}
+
+void CommandTrace::set_capacity(uint16_t capacity) {
+  this->_capacity = capacity;
+  this->_records.assign((size_t) capacity * RECORD_SIZE, 0);
+  this->clear();
+}
+
+void CommandTrace::clear() {
+  this->_head = 0;
+  this->_size = 0;
+  this->_overwritten = 0;
+}
+
+void CommandTrace::record(uint8_t control_type, float state, float brightness, float red, float green, float blue,
+                          float color_temperature, float gamma_correct) {
+  if (this->_capacity == 0)
+    return;
+
+  auto *p = &this->_records[(size_t) this->_head * RECORD_SIZE];
+  put_u32(p, millis());
+  p[4] = control_type;
+  p[5] = (uint8_t) quantize(state, 255.0f, 255);
+  put_u16(p + 6, quantize(brightness, 65535.0f, 65535));
+  put_u16(p + 8, quantize(red, 65535.0f, 65535));
+  put_u16(p + 10, quantize(green, 65535.0f, 65535));
+  put_u16(p + 12, quantize(blue, 65535.0f, 65535));
+  put_u16(p + 14, quantize(color_temperature, 10.0f, 65535));
+  this->_gamma_correct = quantize(gamma_correct, 100.0f, 65535);
+
+  this->_head = (this->_head + 1) % this->_capacity;
+  if (this->_size < this->_capacity) {
+    this->_size++;
+  } else {
+    this->_overwritten++;
+  }
+}
+
+std::vector<uint8_t> CommandTrace::serialize() const {
+  std::vector<uint8_t> data(HEADER_SIZE + (size_t) this->_size * RECORD_SIZE);
+  auto *p = data.data();
+  p[0] = 'X', p[1] = 'Y', p[2] = 'C', p[3] = 'T';
+  p[4] = VERSION;
+  p[5] = RECORD_SIZE;
+  put_u16(p + 6, this->_gamma_correct);
+  put_u32(p + 8, this->_size);
+  put_u32(p + 12, this->_overwritten);
+
+  // Oldest record is at the head once the buffer has wrapped
+  size_t first = this->_size < this->_capacity ? 0 : this->_head;
+  for (size_t i = 0; i < this->_size; i++) {
+    auto *record = &this->_records[((first + i) % this->_capacity) * RECORD_SIZE];
+    std::copy(record, record + RECORD_SIZE, p + HEADER_SIZE + (i * RECORD_SIZE));
+  }
+  return data;
+}
+
+void CommandTrace::dump() {
+  this->_dump = this->serialize();
+  this->_dump_offset = 0;
+  this->_dump_line = 0;
+  ESP_LOGI(TAG, "xytrace begin %u", (unsigned) this->_dump.size());
+}
+
+void CommandTrace::loop() {
+  if (this->_dump.empty())
+    return;
+
+  static const char *const HEX = "0123456789abcdef";
+  char hex[(DUMP_LINE_SIZE * 2) + 1];
+
+  for (uint8_t n = 0; n < DUMP_LINES_PER_LOOP && this->_dump_offset < this->_dump.size(); n++) {
+    size_t len = this->_dump.size() - this->_dump_offset;
+    if (len > DUMP_LINE_SIZE)
+      len = DUMP_LINE_SIZE;
+
+    for (size_t i = 0; i < len; i++) {
+      auto b = this->_dump[this->_dump_offset + i];
+      hex[i * 2] = HEX[b >> 4];
+      hex[(i * 2) + 1] = HEX[b & 0x0f];
+    }
+    hex[len * 2] = '\0';
+
+    ESP_LOGI(TAG, "xytrace %" PRIu32 " %s", this->_dump_line++, hex);
+    this->_dump_offset += len;
+  }
+
+  if (this->_dump_offset >= this->_dump.size()) {
+    ESP_LOGI(TAG, "xytrace end %" PRIu32, this->_dump_line);
+    this->_dump.clear();
+    this->_dump.shrink_to_fit();
+  }
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "esphome/core/component.h"
+
+namespace esphome {
+namespace xy_light {
+
+// Ring buffer of the colour values each control was written with, for capturing real command streams to replay
+// against the pipeline. Oldest records are overwritten once full.
+//
+// Dumped over the logger as numbered lines of hex, which command_trace.py reassembles into the binary format:
+//   header (16 bytes): "XYCT", version, record size, gamma correct * 100 (u16), record count (u32),
+//                      records overwritten before the first one (u32)
+//   record (16 bytes): time ms (u32), control type, state * 255, brightness, red, green, blue (u16 / 65535),
+//                      colour temperature in 0.1 mired (u16)
+// All values are little endian, records are oldest first.
+class CommandTrace : public Component {
+ public:
+  static const uint8_t VERSION = 1;
+  static const uint8_t HEADER_SIZE = 16;
+  static const uint8_t RECORD_SIZE = 16;
+  // Bytes per logged line, kept well within the logger's line buffer
+  static const uint8_t DUMP_LINE_SIZE = 48;
+  static const uint8_t DUMP_LINES_PER_LOOP = 4;
+
+  void set_capacity(uint16_t capacity);
+  uint16_t capacity() const { return this->_capacity; }
+  uint16_t size() const { return this->_size; }
+
+  void record(uint8_t control_type, float state, float brightness, float red, float green, float blue,
+              float color_temperature, float gamma_correct);
+
+  // Header followed by the records, oldest first
+  std::vector<uint8_t> serialize() const;
+
+  // Starts logging the trace, a few lines each loop so the logger and watchdog keep up
+  void dump();
+
+  void clear();
+
+  void loop() override;
+
+ protected:
+  uint16_t _capacity = 0;
+  uint16_t _head = 0;
+  uint16_t _size = 0;
+  uint32_t _overwritten = 0;
+  uint16_t _gamma_correct = 0;
+  std::vector<uint8_t> _records;
+
+  // Snapshot being dumped, so records written meanwhile do not tear it
+  std::vector<uint8_t> _dump;
+  size_t _dump_offset = 0;
+  uint32_t _dump_line = 0;
+};
+
+}  // namespace xy_light
+}  // namespace esphome
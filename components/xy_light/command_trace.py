@@ -0,0 +1,167 @@
+"""Host side reader for light command traces captured by an xy_light's command_trace.
+
+The device dumps its trace over the logger as numbered lines of hex, ie
+
+    [I][xy_light.trace]: xytrace begin 1616
+    [I][xy_light.trace]: xytrace 0 5859435401...
+    ...
+    [I][xy_light.trace]: xytrace end 34
+
+Usage:
+    python3 command_trace.py extract <device log> <trace.bin>
+    python3 command_trace.py info <trace.bin>
+    python3 command_trace.py csv <trace.bin> <trace.csv>
+
+The csv command writes the format replayed by xy_light_simulator. Files are streamed a record at a time,
+so long captures are never held in memory.
+"""
+
+import re
+import struct
+import sys
+from collections import namedtuple
+
+MAGIC = b"XYCT"
+VERSION = 1
+
+HEADER_FORMAT = struct.Struct("<4sBBHII")
+RECORD_FORMAT = struct.Struct("<IBBHHHHH")
+
+Header = namedtuple("Header", ["version", "record_size", "gamma_correct", "record_count", "overwritten"])
+Record = namedtuple(
+    "Record",
+    ["time_ms", "control_type", "state", "brightness", "red", "green", "blue", "color_temperature"]
+)
+
+CSV_COLUMNS = ["time_ms", "transition_ms", "state", "brightness", "red", "green", "blue", "color_temperature"]
+
+_LOG_LINE = re.compile(r"xytrace (begin|end|\d+) ?([0-9a-f]*)")
+
+
+class TraceError(Exception):
+    pass
+
+
+def read_header(f):
+    data = f.read(HEADER_FORMAT.size)
+    if len(data) < HEADER_FORMAT.size:
+        raise TraceError("truncated header")
+
+    (magic, version, record_size, gamma, count, overwritten) = HEADER_FORMAT.unpack(data)
+    if magic != MAGIC:
+        raise TraceError("not a command trace")
+    if version != VERSION:
+        raise TraceError(f"unsupported trace version {version}")
+    if record_size < RECORD_FORMAT.size:
+        raise TraceError(f"record size {record_size} is too small")
+
+    return Header(version, record_size, gamma / 100.0, count, overwritten)
+
+
+def iter_records(f, header=None):
+    """Yields each Record of a binary trace, oldest first, with values scaled back to the light's ranges."""
+    if header is None:
+        header = read_header(f)
+
+    for i in range(header.record_count):
+        data = f.read(header.record_size)
+        if len(data) < header.record_size:
+            raise TraceError(f"truncated at record {i} of {header.record_count}")
+
+        (time_ms, control_type, state, brightness, r, g, b, ct) = RECORD_FORMAT.unpack_from(data)
+        yield Record(
+            time_ms,
+            control_type,
+            state / 255.0,
+            brightness / 65535.0,
+            r / 65535.0,
+            g / 65535.0,
+            b / 65535.0,
+            ct / 10.0,
+        )
+
+
+def is_binary_trace(path):
+    with open(path, "rb") as f:
+        return f.read(len(MAGIC)) == MAGIC
+
+
+def extract_from_log(lines, out):
+    """Writes the first complete dump found in the log lines to the binary file out, returns its size in bytes."""
+    expected_size = None
+    next_line = 0
+    written = 0
+
+    for line in lines:
+        m = _LOG_LINE.search(line)
+        if not m:
+            continue
+
+        (kind, payload) = m.groups()
+        if kind == "begin":
+            expected_size = int(payload)
+            next_line = 0
+            written = 0
+            out.seek(0)
+            out.truncate()
+        elif expected_size is None:
+            continue
+        elif kind == "end":
+            if written != expected_size:
+                raise TraceError(f"dump ended after {written} of {expected_size} bytes")
+            return written
+        else:
+            if int(kind) != next_line:
+                raise TraceError(f"missing dump line {next_line}, the logger may have dropped it")
+            next_line += 1
+            out.write(bytes.fromhex(payload))
+            written += len(payload) // 2
+
+    raise TraceError("no complete dump found")
+
+
+def write_csv(records, out):
+    """Writes records in xy_light_simulator's trace format. Each record is replayed as is (ie without a transition),
+    as the device records every step of a transition."""
+    out.write("# " + ", ".join(CSV_COLUMNS) + "\n")
+    start = None
+    for r in records:
+        if start is None:
+            start = r.time_ms
+        out.write(
+            f"{(r.time_ms - start) & 0xFFFFFFFF},0,{r.state:.4f},{r.brightness:.5f},"
+            f"{r.red:.5f},{r.green:.5f},{r.blue:.5f},{r.color_temperature:.1f}\n"
+        )
+
+
+def _main(argv):
+    if len(argv) == 4 and argv[1] == "extract":
+        with open(argv[2], encoding="utf-8", errors="replace") as log, open(argv[3], "wb") as out:
+            size = extract_from_log(log, out)
+        print(f"wrote {size} bytes to {argv[3]}")
+    elif len(argv) == 3 and argv[1] == "info":
+        with open(argv[2], "rb") as f:
+            header = read_header(f)
+            first = last = None
+            for r in iter_records(f, header):
+                first = r if first is None else first
+                last = r
+        print(f"version {header.version}, {header.record_count} records, {header.overwritten} overwritten, "
+              f"gamma correct {header.gamma_correct}")
+        if first is not None:
+            print(f"spans {(last.time_ms - first.time_ms) / 1000.0:.1f}s")
+    elif len(argv) == 4 and argv[1] == "csv":
+        with open(argv[2], "rb") as f, open(argv[3], "w", encoding="utf-8") as out:
+            write_csv(iter_records(f), out)
+    else:
+        print(__doc__)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    try:
+        sys.exit(_main(sys.argv))
+    except TraceError as err:
+        print(f"error: {err}", file=sys.stderr)
+        sys.exit(1)
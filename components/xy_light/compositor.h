@@ -0,0 +1,79 @@
+#pragma once
+#include <algorithm>
+#include <stdint.h>
+#include <vector>
+
+#include "esphome/components/xy_light/matrices.h"
+
+namespace esphome {
+namespace xy_light {
+
+enum class BlendMode : uint8_t {
+  // Light of the layer is added to the layers below it
+  ADD = 0,
+  // Brightest of the layer and the layers below, per XYZ component
+  MAX,
+  // Layer covers the layers below it, by its weight while it is on (ie an effect over a base colour)
+  OVER
+};
+
+struct XyLayer {
+  BlendMode mode = BlendMode::ADD;
+  float weight = 1.0f;
+
+  // White balanced XYZ of the layer for the current frame, brightness included
+  matrices::Vec3 XYZ;
+  // On / off state, so that OVER layers only cover the layers below while on
+  float state = 0.0f;
+};
+
+// Blends the colour of each control of a light in XYZ, so the outputs are transformed once for all of them.
+// Layers are blended in the order they were added, ie the order of the light's controls.
+class XyCompositor {
+ protected:
+  std::vector<XyLayer> _layers;
+
+ public:
+  uint8_t add_layer(BlendMode mode, float weight) {
+    XyLayer layer;
+    layer.mode = mode;
+    layer.weight = weight;
+    this->_layers.push_back(layer);
+    return (uint8_t) (this->_layers.size() - 1);
+  }
+
+  size_t size() const { return this->_layers.size(); }
+
+  void set(uint8_t index, const matrices::Vec3 &XYZ, float state) {
+    auto &layer = this->_layers[index];
+    layer.XYZ = XYZ;
+    layer.state = state;
+  }
+
+  matrices::Vec3 composite() const {
+    matrices::Vec3 XYZ;
+    for (auto &layer : this->_layers) {
+      auto w = layer.weight;
+      switch (layer.mode) {
+        case BlendMode::ADD:
+          XYZ = matrices::Vec3(XYZ.x + (layer.XYZ.x * w), XYZ.y + (layer.XYZ.y * w), XYZ.z + (layer.XYZ.z * w));
+          break;
+        case BlendMode::MAX:
+          XYZ = matrices::Vec3(std::max(XYZ.x, layer.XYZ.x * w), std::max(XYZ.y, layer.XYZ.y * w),
+                               std::max(XYZ.z, layer.XYZ.z * w));
+          break;
+        case BlendMode::OVER: {
+          auto a = w * layer.state;
+          auto b = 1.0f - a;
+          XYZ = matrices::Vec3((XYZ.x * b) + (layer.XYZ.x * a), (XYZ.y * b) + (layer.XYZ.y * a),
+                               (XYZ.z * b) + (layer.XYZ.z * a));
+          break;
+        }
+      }
+    }
+    return XYZ;
+  }
+};
+
+}  // namespace xy_light
+}  // namespace esphome
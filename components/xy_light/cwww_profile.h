@@ -1,6 +1,12 @@
 #pragma once
+#include <algorithm>
+#include <limits>
+#include <memory>
+
 #include "esphome/core/component.h"
 #include "esphome/components/xy_light/color_spaces.h"
+#include "esphome/components/xy_light/lut2d.h"
+#include "esphome/components/xy_light/profiling.h"
 
 namespace esphome {
 namespace xy_light {
@@ -28,6 +34,7 @@ class CwWwChromaTransform {
   optional<float> _white_point_mired;
 
   color_space::CwWwIntensityCalibration _int_cal;
+  optional<color_space::CwWwIntensityCalibrationFixed> _int_cal_fixed;
 
   // Greater the rate of decay:
   // - more colour accurate
@@ -41,22 +48,51 @@ class CwWwChromaTransform {
   //float _impurity_attn_decay_gamma = 1.5f;
   float _impurity_attn_decay_gamma = 3.0f;
 
+  color_space::TransferFunction _gamma_compress = color_space::TransferFunction::exp_gamma_compress(1.00f);
+  color_space::TransferFunction _gamma_decompress = color_space::TransferFunction::exp_gamma_decompress(1.00f);
+  color_space::TransferFunction _impurity_attn_decay =
+      color_space::TransferFunction::exp_gamma_decompress(this->_impurity_attn_decay_gamma);
+
+  // Optional table of CCT and Duv over uv, which replaces the CCT / Duv solve. The attenuation and cold / warm
+  // split are still calculated from them, as both have a sharp peak on the locus that interpolating the final
+  // levels would flatten. Only covers the region the levels can be non zero, so is discarded by the setters
+  // which move its edges. Shared by copies of the transform, so outputs with the same profile hold one table.
+  uint8_t _uv_lut_grid_size = 0;
+  std::shared_ptr<const Lut2d> _uv_lut;
+
  public:
-  void set_gamma(float g) { this->_gamma = g; }
+  void set_gamma(float g) {
+    this->_gamma = g;
+    this->_gamma_compress = color_space::TransferFunction::exp_gamma_compress(g);
+    this->_gamma_decompress = color_space::TransferFunction::exp_gamma_decompress(g);
+  }
 
-  void set_max_cold_white_intensity(float i) { this->_int_cal.max_cw = i; }
-  void set_max_warm_white_intensity(float i) { this->_int_cal.max_ww = i; }
-  void set_max_combined_white_intensity(float i) { this->_int_cal.max_combined = i; }
+  // grid_size points per axis, or 0 to evaluate the CCT / Duv split exactly
+  void set_uv_lut_grid_size(uint8_t grid_size) {
+    this->_uv_lut_grid_size = grid_size;
+    this->_uv_lut.reset();
+  }
 
-  void set_min_cold_white_intensity(float i) { this->_int_cal.min_cw = i; }
-  void set_min_warm_white_intensity(float i) { this->_int_cal.min_ww = i; }
-  void set_min_combined_white_intensity(float i) { this->_int_cal.min_combined = i; }
+  // Builds the uv table now, if enabled, so that copies taken afterwards share it rather than each building one
+  void share_uv_lut() {
+    if (this->_uv_lut_grid_size != 0)
+      this->uv_lut();
+  }
+
+  void set_max_cold_white_intensity(float i) { this->_int_cal.max_cw = i; this->_int_cal_fixed.reset(); }
+  void set_max_warm_white_intensity(float i) { this->_int_cal.max_ww = i; this->_int_cal_fixed.reset(); }
+  void set_max_combined_white_intensity(float i) { this->_int_cal.max_combined = i; this->_int_cal_fixed.reset(); }
+
+  void set_min_cold_white_intensity(float i) { this->_int_cal.min_cw = i; this->_int_cal_fixed.reset(); }
+  void set_min_warm_white_intensity(float i) { this->_int_cal.min_ww = i; this->_int_cal_fixed.reset(); }
+  void set_min_combined_white_intensity(float i) { this->_int_cal.min_combined = i; this->_int_cal_fixed.reset(); }
 
   void set_warm_white(float mired) {
     auto ww = color_space::ColorTemperature::from_mired(mired);
     this->_warm_white_k = ww.as_kelvin();
     this->_warm_white_mired = mired;
     this->_red_wb_impurity_k = ww.add_mired(this->_red_wb_impurity_threshold_mired).as_kelvin();
+    this->_uv_lut.reset();
   }
 
   void set_cold_white(float mired) {
@@ -64,6 +100,7 @@ class CwWwChromaTransform {
     this->_cold_white_k = cw.as_kelvin();
     this->_cold_white_mired = mired;
     this->_blue_wb_impurity_k = cw.sub_mired(this->_blue_wb_impurity_threshold_mired).as_kelvin();
+    this->_uv_lut.reset();
   }
 
   void set_white_point(float mired) {
@@ -74,25 +111,35 @@ class CwWwChromaTransform {
     this->_red_wb_impurity_k = color_space::ColorTemperature::from_kelvin(this->_warm_white_k)
                                    .add_mired(this->_red_wb_impurity_threshold_mired)
                                    .as_kelvin();
+    this->_uv_lut.reset();
   }
 
   void set_blue_wb_impurity(float mired) {
     this->_blue_wb_impurity_k = color_space::ColorTemperature::from_kelvin(this->_cold_white_k)
                                     .sub_mired(this->_blue_wb_impurity_threshold_mired)
                                     .as_kelvin();
+    this->_uv_lut.reset();
   }
 
-  void set_green_tint_duv_impurity(float duv) { this->_green_tint_duv_impurity = duv; }
+  void set_green_tint_duv_impurity(float duv) {
+    this->_green_tint_duv_impurity = duv;
+    this->_uv_lut.reset();
+  }
 
-  void set_purple_tint_duv_impurity(float duv) { this->_purple_tint_duv_impurity = duv; }
+  void set_purple_tint_duv_impurity(float duv) {
+    this->_purple_tint_duv_impurity = duv;
+    this->_uv_lut.reset();
+  }
 
-  void set_impurity_decay_gamma(float g) { this->_impurity_attn_decay_gamma = g; }
+  void set_impurity_decay_gamma(float g) {
+    this->_impurity_attn_decay_gamma = g;
+    this->_impurity_attn_decay = color_space::TransferFunction::exp_gamma_decompress(g);
+  }
 
  private:
-  float tint_impurity_attenuation_factor(color_space::xyY_Cie1931 t_xyY) {
-    return color_space::Xy_Cie1931(t_xyY.x, t_xyY.y)
-        .as_uv_cie1960()
-        .tint_impurity(this->_green_tint_duv_impurity, this->_purple_tint_duv_impurity);
+  float tint_impurity_attenuation_factor(color_space::CctDuv cct_duv) {
+    return color_space::Uv_Cie1960::tint_impurity(cct_duv, this->_green_tint_duv_impurity,
+                                                  this->_purple_tint_duv_impurity);
   }
 
   float wb_impurity_attenuation_factor(float k) {
@@ -108,17 +155,75 @@ class CwWwChromaTransform {
 
  public:
   color_space::CwWw XYZ_to_CwWw(color_space::XYZ_Cie1931 XYZ) {
+    return this->calibrate(this->XYZ_to_uncalibrated_CwWw(XYZ));
+  }
+
+  // Light of the cold and warm white channels at the given (gamma compressed) levels
+  color_space::XYZ_Cie1931 CwWw_to_XYZ(color_space::CwWw cwww) {
+    auto cw_p = color_space::PlanckianLocus::at_mired(this->_cold_white_mired);
+    auto ww_p = color_space::PlanckianLocus::at_mired(this->_warm_white_mired);
+    auto linear = color_space::CwWw(clamp(cwww.cw, 0.0f, 1.0f), clamp(cwww.ww, 0.0f, 1.0f))
+                      .gamma_decompress(this->_gamma_decompress);
+    auto cw = color_space::Uv_Cie1960(cw_p.u, cw_p.v).as_xy_cie1931().as_XYZ_cie1931(linear.cw);
+    auto ww = color_space::Uv_Cie1960(ww_p.u, ww_p.v).as_xy_cie1931().as_XYZ_cie1931(linear.ww);
+    return color_space::XYZ_Cie1931(cw.X + ww.X, cw.Y + ww.Y, cw.Z + ww.Z);
+  }
+
+  // A colour temperature on the locus, which needs no CCT / Duv solve
+  color_space::CwWw CT_to_CwWw(float mired, float Y) {
+    return this->calibrate(this->CctDuv_to_uncalibrated_CwWw(color_space::PlanckianLocus::on_locus(mired), Y));
+  }
+
+ protected:
+  color_space::CwWw calibrate(color_space::CwWw cwww) {
+    // Fully attenuated, skip calibration so off stays off
+    if (cwww.cw == 0.0f && cwww.ww == 0.0f) {
+      return cwww;
+    }
+    XY_PROFILE_STAGE(PROFILE_CALIBRATION);
+    return this->_int_cal.apply_calibration(cwww);
+  }
+
+ public:
+  // Fixed point pipeline, the CCT / Duv split stays in float while calibration is integer math.
+  // x is cold white, y is warm white.
+  fixed_point::Vec2 XYZ_to_CwWw_fixed(const fixed_point::Vec3 &XYZ) {
+    auto cwww = this->XYZ_to_uncalibrated_CwWw(color_space::XYZ_Cie1931::from_fixed(XYZ));
+
+    XY_PROFILE_STAGE(PROFILE_CALIBRATION);
+    if (!this->_int_cal_fixed.has_value()) {
+      this->_int_cal_fixed = color_space::CwWwIntensityCalibrationFixed(this->_int_cal);
+    }
+    return this->_int_cal_fixed.value().apply_calibration(
+        fixed_point::Vec2(fixed_point::from_float(cwww.cw), fixed_point::from_float(cwww.ww)));
+  }
+
+ protected:
+  color_space::CwWw XYZ_to_uncalibrated_CwWw(color_space::XYZ_Cie1931 XYZ) {
     auto t_xyY = XYZ.as_xyY_cie1931();
 
+    if (this->_uv_lut_grid_size != 0) {
+      auto uv = t_xyY.as_xy_cie1931().as_uv_cie1960();
+      float cct_duv[Lut2d::MAX_CHANNELS];
+      if (!this->uv_lut().lookup(uv.u, uv.v, cct_duv))
+        return {0.0f, 0.0f};
+      return this->CctDuv_to_uncalibrated_CwWw({cct_duv[0], cct_duv[1], true}, t_xyY.Y);
+    }
+
+    // CCT and Duv in a single pass
+    return this->CctDuv_to_uncalibrated_CwWw(t_xyY.as_xy_cie1931().as_uv_cie1960().cct_duv(), t_xyY.Y);
+  }
+
+  color_space::CwWw CctDuv_to_uncalibrated_CwWw(color_space::CctDuv cct_duv, float Y) {
     // Reduce the brightness the future the target colour is from the planckian locus
-    auto tint_impurity_attn = this->tint_impurity_attenuation_factor(t_xyY);
+    auto tint_impurity_attn = this->tint_impurity_attenuation_factor(cct_duv);
 
-    // Exit early if we can, as calculating approximate color temp is very cpu intensive
     if (tint_impurity_attn == 0.0f) {
       return {0.0f, 0.0f};
     }
 
-    auto k = t_xyY.cct_kelvin_approx();
+    auto mired = cct_duv.mired;
+    auto k = 1000000.0f / mired;
     auto wb_impurity_attn = this->wb_impurity_attenuation_factor(k);
 
     // Rather then multiplying the attenuations, take the smallest of the two.
@@ -129,26 +234,70 @@ class CwWwChromaTransform {
       return {0.0f, 0.0f};
     }
 
-    auto brightness = powf(impurity_attn, this->_impurity_attn_decay_gamma) * t_xyY.Y;
+    auto brightness = this->_impurity_attn_decay(impurity_attn) * Y;
 
     if (brightness == 0.0f) {
       return {0.0f, 0.0f};
     }
 
     float wp = this->white_point_mired();
-    auto mired = 1000000.0f / k;
 
     auto cw = (1 - ((mired - wp) / (this->_warm_white_mired - wp))) * brightness;
     auto ww = (1 - ((wp - mired) / (wp - this->_cold_white_mired))) * brightness;
     auto cwww = color_space::CwWw(cw, ww);
 
-    cwww = cwww.gamma_compress(this->_gamma);
-    cwww = this->_int_cal.apply_calibration(cwww);
+    return cwww.gamma_compress(this->_gamma_compress);
+  }
 
-    return cwww;
+  const Lut2d &uv_lut() {
+    if (!this->_uv_lut) {
+      // Levels are zero beyond the wb impurity limits, and further than the larger tint impurity from the locus
+      auto min_mired = color_space::planckian_locus::MIN_VALID_MIRED;
+      if (this->_blue_wb_impurity_k > 0.0f)
+        min_mired = std::max(min_mired, 1000000.0f / this->_blue_wb_impurity_k);
+      auto max_mired = std::min(color_space::planckian_locus::MAX_VALID_MIRED, 1000000.0f / this->_red_wb_impurity_k);
+
+      float u_min = 1.0f, u_max = 0.0f, v_min = 1.0f, v_max = 0.0f;
+      for (auto mired = min_mired;; mired += color_space::planckian_locus::MIRED_STEP) {
+        mired = std::min(mired, max_mired);
+        auto p = color_space::PlanckianLocus::at_mired(mired);
+        u_min = std::min(u_min, p.u), u_max = std::max(u_max, p.u);
+        v_min = std::min(v_min, p.v), v_max = std::max(v_max, p.v);
+        if (mired >= max_mired)
+          break;
+      }
+      auto margin = std::max(this->_green_tint_duv_impurity, this->_purple_tint_duv_impurity);
+
+      Lut2d lut(this->_uv_lut_grid_size, u_min - margin, u_max + margin, v_min - margin, v_max + margin);
+      for (size_t i = 0; i < lut.grid_size(); i++) {
+        for (size_t j = 0; j < lut.grid_size(); j++) {
+          auto u = lut.grid_u(i), v = lut.grid_v(j);
+          auto cct_duv = color_space::Uv_Cie1960(u, v).cct_duv();
+
+          // Duv beyond DUV_LIMIT is kept as solved, so it still attenuates to off when interpolated towards the
+          // locus. Points the solve rejects outright take the signed distance to the nearest point of the locus,
+          // so that interpolating towards them does not cross Duv = 0.
+          if (!cct_duv.valid && cct_duv.mired == 0.0f) {
+            auto nearest = std::numeric_limits<float>::max();
+            for (auto mired = min_mired; mired <= max_mired; mired += color_space::planckian_locus::MIRED_STEP) {
+              auto p = color_space::PlanckianLocus::at_mired(mired);
+              auto dist = ((u - p.u) * (u - p.u)) + ((v - p.v) * (v - p.v));
+              if (dist < nearest) {
+                nearest = dist;
+                cct_duv.mired = mired;
+                cct_duv.duv = ((v - p.v) * p.tangent_u) - ((u - p.u) * p.tangent_v);
+              }
+            }
+          }
+          float values[Lut2d::MAX_CHANNELS] = {cct_duv.mired, cct_duv.duv};
+          lut.set(i, j, values);
+        }
+      }
+      this->_uv_lut = std::make_shared<const Lut2d>(std::move(lut));
+    }
+    return *this->_uv_lut;
   }
 
- protected:
   float &white_point_mired() {
     if (!this->_white_point_mired.has_value()) {
       this->_white_point_mired = (this->_warm_white_mired + this->_cold_white_mired) / 2;
@@ -164,6 +313,8 @@ class CwWwProfile : public Component {
  public:
   void set_gamma(float g) { this->_chroma_transform.set_gamma(g); }
 
+  void set_uv_lut_grid_size(uint8_t grid_size) { this->_chroma_transform.set_uv_lut_grid_size(grid_size); }
+
   void set_max_cold_white_intensity(float i) { this->_chroma_transform.set_max_cold_white_intensity(i); }
   void set_max_warm_white_intensity(float i) { this->_chroma_transform.set_max_warm_white_intensity(i); }
   void set_max_combined_white_intensity(float i) { this->_chroma_transform.set_max_combined_white_intensity(i); }
@@ -188,7 +339,11 @@ class CwWwProfile : public Component {
 
   void set_blue_wb_impurity(float mired) { this->_chroma_transform.set_blue_wb_impurity(mired); }
 
-  CwWwChromaTransform get_chroma_transform() { return this->_chroma_transform; }
+  // Each output keeps a copy, which shares the profile's uv table
+  CwWwChromaTransform get_chroma_transform() {
+    this->_chroma_transform.share_uv_lut();
+    return this->_chroma_transform;
+  }
 };
 
 }  // namespace xy_light
@@ -9,6 +9,7 @@ from .profile import CONF_PROFILE_GAMMA
 from .profile import CONF_PROFILE_IMPURITY_GAMMA_DECAY
 from .profile import (CONF_PROFILE_GREEN_TINT_IMPURITY, CONF_PROFILE_PURPLE_TINT_IMPURITY)
 from .profile import (CONF_PROFILE_RED_CCT_IMPURITY, CONF_PROFILE_BLUE_CCT_IMPURITY)
+from .profile import CONF_PROFILE_UV_LUT_GRID_SIZE
 
 from .profile import (CONF_PROFILE_WHITE_POINT_COLOR_TEMPERATURE, CONF_PROFILE_COLD_WHITE_COLOR_TEMPERATURE,CONF_PROFILE_WARM_WHITE_COLOR_TEMPERATURE)
 
@@ -34,6 +35,7 @@ CWWW_PROFILE_CONFIG_SCHEMA  = cv.Schema({
     cv.Required(CONF_PROFILE_COLD_WHITE_COLOR_TEMPERATURE): cv.color_temperature,
     cv.Required(CONF_PROFILE_WARM_WHITE_COLOR_TEMPERATURE): cv.color_temperature,
     cv.Optional(CONF_PROFILE_GAMMA): cv.positive_float,
+    cv.Optional(CONF_PROFILE_UV_LUT_GRID_SIZE): xy_cv.uv_lut_grid_size,
 
     cv.Optional(CONF_PROFILE_MAX_WARM_WHITE_INTENSITY): cv.percentage,
     cv.Optional(CONF_PROFILE_MAX_COLD_WHITE_INTENSITY): cv.percentage,
@@ -52,6 +54,10 @@ async def to_cwww_profile_code(config):
         g = config[CONF_PROFILE_GAMMA]
         cg.add(var.set_gamma(g))
 
+    if CONF_PROFILE_UV_LUT_GRID_SIZE in config:
+        n = config[CONF_PROFILE_UV_LUT_GRID_SIZE]
+        cg.add(var.set_uv_lut_grid_size(n))
+
     if CONF_PROFILE_MAX_WARM_WHITE_INTENSITY in config:
         i = config[CONF_PROFILE_MAX_WARM_WHITE_INTENSITY]
         cg.add(var.set_max_warm_white_intensity(i))
@@ -2,6 +2,7 @@
 #include "esphome/core/log.h"
 #include "esphome/core/component.h"
 #include "esphome/components/output/float_output.h"
+#include "esphome/components/xy_light/calibration_telemetry.h"
 #include "esphome/components/xy_light/xy_output.h"
 #include "esphome/components/xy_light/cwww_profile.h"
 
@@ -12,33 +13,66 @@ class CwWwXyOutput : public Component, public XyOutput {
  protected:
   CwWwChromaTransform _cwww_profile_transform;
   bool _calibration_logging = false;
-  output::FloatOutput *_warm_white = NULL;
-  output::FloatOutput *_cold_white = NULL;
+  XyChannel _warm_white{"warm_white"};
+  XyChannel _cold_white{"cold_white"};
 
  public:
   void set_color_XYZ(float X, float Y, float Z) override {
     auto XYZ = color_space::XYZ_Cie1931(X, Y, Z);
-    auto cwww = this->_cwww_profile_transform.XYZ_to_CwWw(XYZ);
+    this->write_cwww(this->_cwww_profile_transform.XYZ_to_CwWw(XYZ));
+  }
+
+  void set_color_CT(const XyCtFrame &ct, float /*r*/, float /*g*/, float /*b*/) override {
+    this->write_cwww(this->_cwww_profile_transform.CT_to_CwWw(ct.mired, ct.Y));
+  }
+
+  void set_color_CT_XYZ(const XyCtFrame &ct, float /*X*/, float /*Y*/, float /*Z*/) override {
+    this->write_cwww(this->_cwww_profile_transform.CT_to_CwWw(ct.mired, ct.Y));
+  }
+
+  void set_color_XYZ_fixed(const fixed_point::Vec3 &XYZ) override {
+    auto cwww = this->_cwww_profile_transform.XYZ_to_CwWw_fixed(XYZ);
 
     if (this->_calibration_logging)
-      this->log_calibration_data(cwww);
-    cwww = cwww.clamp_truncate();
-    if (this->_cold_white)
-      this->_cold_white->set_level(cwww.cw);
+      this->log_calibration_data(color_space::CwWw::from_fixed(cwww));
 
-    if (this->_warm_white)
-      this->_warm_white->set_level(cwww.ww);
+    this->write_level(this->_cold_white, cwww.x);
+    this->write_level(this->_warm_white, cwww.y);
+    this->commit_frame();
   }
 
   void enable_calibration_logging(bool enable) { this->_calibration_logging = enable; }
 
+  std::vector<XyChannel *> channels() override { return {&this->_cold_white, &this->_warm_white}; }
+
+  optional<color_space::XYZ_Cie1931> levels_to_XYZ(const float *levels) override {
+    return this->_cwww_profile_transform.CwWw_to_XYZ(color_space::CwWw(levels[0], levels[1]));
+  }
+
   void set_profile(CwWwProfile *profile) { this->_cwww_profile_transform = profile->get_chroma_transform(); }
 
-  void set_warm_white_output(output::FloatOutput *warm_white) { this->_warm_white = warm_white; }
+  void set_warm_white_output(output::FloatOutput *warm_white) { this->_warm_white.output = warm_white; }
+
+  void set_cold_white_output(output::FloatOutput *cold_white) { this->_cold_white.output = cold_white; }
+
+ protected:
+  void write_cwww(color_space::CwWw cwww) {
+    if (this->_calibration_logging && !this->capturing())
+      this->log_calibration_data(cwww);
 
-  void set_cold_white_output(output::FloatOutput *cold_white) { this->_cold_white = cold_white; }
+    cwww = cwww.clamp_truncate();
+    this->write_level(this->_cold_white, cwww.cw);
+    this->write_level(this->_warm_white, cwww.ww);
+    this->commit_frame();
+  }
 
+ public:
   static void log_calibration_data(color_space::CwWw cwww) {
+    CalibrationTelemetry::instance()->push(&CwWwXyOutput::format_calibration_data, {cwww.cw, cwww.ww});
+  }
+
+  static void format_calibration_data(const float *values) {
+    auto cwww = color_space::CwWw(values[0], values[1]);
     auto cwww_max = cwww.max();
     ESP_LOGI("output.cwww_xy_output", "Normalized: [CW %.2f%%, WW %.2f%%] Actual: [CW %.2f%%, WW %.2f%%]",
           (cwww.cw / cwww_max) * 100.0f, 
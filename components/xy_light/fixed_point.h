@@ -0,0 +1,127 @@
+#pragma once
+#include <math.h>
+#include <stdint.h>
+
+#include "esphome/components/xy_light/matrices.h"
+
+namespace esphome {
+namespace xy_light {
+namespace fixed_point {
+
+// Signed Q7.24 fixed point, used by the integer colour pipeline on targets without an FPU.
+// 16 fractional bits are not enough to hold the chromaticity of dim XYZ values, which skews the CCT of
+// white channels at low brightness. 24 bits costs nothing extra, as products and quotients are
+// widened to 64 bit regardless (still far cheaper than soft-float), and leaves a range of +/-128.
+typedef int32_t fixed_t;
+
+static const int FRACTION_BITS = 24;
+static const fixed_t ONE = 1 << FRACTION_BITS;
+
+// Conversions to and from float are intended for setup, or the boundaries of the pipeline only
+inline fixed_t from_float(float v) { return (fixed_t) lroundf(v * (float) ONE); }
+
+inline float to_float(fixed_t v) { return (float) v * (1.0f / (float) ONE); }
+
+inline fixed_t mul(fixed_t a, fixed_t b) { return (fixed_t) (((int64_t) a * (int64_t) b) >> FRACTION_BITS); }
+
+// Quotients saturate rather than wrap, as dividing by a near zero chromaticity can exceed the range
+inline fixed_t saturate(int64_t v) { return v > INT32_MAX ? INT32_MAX : (v < INT32_MIN ? INT32_MIN : (fixed_t) v); }
+
+inline fixed_t div(fixed_t a, fixed_t b) {
+  if (b == 0)
+    return 0;
+  return saturate(((int64_t) a * ONE) / (int64_t) b);
+}
+
+// a * b / c, without losing the precision of the intermediate product
+inline fixed_t mul_div(fixed_t a, fixed_t b, fixed_t c) {
+  if (c == 0)
+    return 0;
+  return saturate(((int64_t) a * (int64_t) b) / (int64_t) c);
+}
+
+inline fixed_t max(fixed_t a, fixed_t b) { return a > b ? a : b; }
+
+inline fixed_t clamp_unit(fixed_t v) { return v < 0 ? 0 : (v > ONE ? ONE : v); }
+
+// Round a [0, 1] value to the nearest duty code of an output with the given bit depth
+inline uint32_t to_duty(fixed_t v, uint8_t bit_depth) {
+  auto max_duty = (int64_t) ((uint32_t(1) << bit_depth) - 1);
+  return (uint32_t) (((int64_t) clamp_unit(v) * max_duty + (ONE / 2)) >> FRACTION_BITS);
+}
+
+struct Vec2 {
+  fixed_t x;
+  fixed_t y;
+
+  Vec2() : x(0), y(0) {}
+  Vec2(fixed_t x, fixed_t y) : x(x), y(y) {}
+
+  fixed_t max() const { return fixed_point::max(this->x, this->y); }
+};
+
+struct Vec3 {
+  fixed_t x;
+  fixed_t y;
+  fixed_t z;
+
+  Vec3() : x(0), y(0), z(0) {}
+  Vec3(fixed_t x, fixed_t y, fixed_t z) : x(x), y(y), z(z) {}
+
+  static Vec3 from_float(float x, float y, float z) {
+    return Vec3(fixed_point::from_float(x), fixed_point::from_float(y), fixed_point::from_float(z));
+  }
+
+  static Vec3 from_float(const matrices::Vec3 &v) { return Vec3::from_float(v.x, v.y, v.z); }
+
+  fixed_t max() const { return fixed_point::max(this->x, fixed_point::max(this->y, this->z)); }
+
+  Vec3 scale(fixed_t s) const { return Vec3(mul(this->x, s), mul(this->y, s), mul(this->z, s)); }
+
+  Vec3 operator*(const Vec3 &v) const { return Vec3(mul(this->x, v.x), mul(this->y, v.y), mul(this->z, v.z)); }
+};
+
+struct Matrix3x3 {
+  fixed_t m[3][3];
+
+  Matrix3x3() : m{} {}
+
+  static Matrix3x3 from_float(const matrices::Matrix3x3 &f) {
+    Matrix3x3 r;
+    for (int i = 0; i < 3; i++) {
+      for (int j = 0; j < 3; j++) {
+        r.m[i][j] = fixed_point::from_float(f.m[i][j]);
+      }
+    }
+    return r;
+  }
+
+  Vec3 operator*(const Vec3 &v) const {
+    // Accumulate each row at full precision before shifting back down
+    return Vec3((fixed_t) ((((int64_t) m[0][0] * v.x) + ((int64_t) m[0][1] * v.y) + ((int64_t) m[0][2] * v.z)) >>
+                         FRACTION_BITS),
+                (fixed_t) ((((int64_t) m[1][0] * v.x) + ((int64_t) m[1][1] * v.y) + ((int64_t) m[1][2] * v.z)) >>
+                         FRACTION_BITS),
+                (fixed_t) ((((int64_t) m[2][0] * v.x) + ((int64_t) m[2][1] * v.y) + ((int64_t) m[2][2] * v.z)) >>
+                         FRACTION_BITS));
+  }
+};
+
+// xyY (Y as luminance) <-> XYZ, mirroring color_space::XYZ_Cie1931 / xyY_Cie1931
+inline Vec3 XYZ_to_xyY(const Vec3 &XYZ) {
+  auto sum = XYZ.x + XYZ.y + XYZ.z;
+  if (sum <= 0)
+    return Vec3(0, 0, XYZ.y);
+  return Vec3(div(XYZ.x, sum), div(XYZ.y, sum), XYZ.y);
+}
+
+inline Vec3 xyY_to_XYZ(const Vec3 &xyY) {
+  if (xyY.y <= 0)
+    return Vec3(0, xyY.z, 0);
+  auto Y_y = div(xyY.z, xyY.y);
+  return Vec3(mul(xyY.x, Y_y), xyY.z, mul(ONE - xyY.x - xyY.y, Y_y));
+}
+
+}  // namespace fixed_point
+}  // namespace xy_light
+}  // namespace esphome
@@ -1,13 +1,22 @@
 import esphome.codegen as cg
 import esphome.config_validation as cv
+import esphome.final_validate as fv
 from esphome.components import light, output
 from esphome.const import CONF_ID
+from esphome.core import CORE
 
 from . import validation as xy_cv
 
-from .xy_output import (xy_light_ns, XyOutput, CONF_XY_OUTPUT_CALIBRATION_LOGGING)
+from .xy_output import (xy_light_ns, XyOutput, CONF_XY_OUTPUT_CALIBRATION_LOGGING, to_calibration_logging_code)
 
-from .rgb_profile import (RGB_PROFILE_CONFIG_SCHEMA, RgbProfile, to_rgb_profile_code)
+from .rgb_profile import (
+    RGB_PROFILE_CONFIG_SCHEMA, 
+    STANDARD_PROFILE_CHROMATICITIES, 
+    RgbProfile, 
+    to_rgb_profile_code, 
+    to_transform_matrices_expressions
+)
+from .profile import CONF_PROFILE_STANDARD_PROFILE__SRGB
 from .cwww_profile import (CWWW_PROFILE_CONFIG_SCHEMA, CwWwProfile, to_cwww_profile_code)
 from .white_profile import (WHITE_PROFILE_CONFIG_SCHEMA, WhiteProfile, to_white_profile_code)
 
@@ -21,8 +30,11 @@ from .white_xy_output import (WHITE_XY_OUTPUT_CONFIG_SCHEMA, to_white_xy_output_
 CODEOWNERS = ["@jamesjharper"]
 
 XyLightControl = xy_light_ns.class_("XyLightControl", light.LightOutput, cg.Component)
-XyLightOutput = xy_light_ns.class_("XyLightOutput")
+XyLightOutput = xy_light_ns.class_("XyLightOutput", cg.Component)
 ControlType = xy_light_ns.enum("ControlType", is_class=True)
+BlendMode = xy_light_ns.enum("BlendMode", is_class=True)
+CommandTrace = xy_light_ns.class_("CommandTrace", cg.Component)
+AsyncFrameWriter = xy_light_ns.class_("AsyncFrameWriter", cg.Component)
 
 CONF_XY_LIGHT_CONTROL_ID = "control_id"
 
@@ -36,6 +48,25 @@ CONF_CONTROL_TYPE = "control_type"
 
 CONF_CONTROL_TEMPERATURE_RANGE = "color_temperature_range"
 
+CONF_LAYER = "layer"
+CONF_LAYER_BLEND_MODE = "blend_mode"
+CONF_LAYER_WEIGHT = "weight"
+
+CONF_FIXED_POINT = "fixed_point"
+CONF_LUT_GRID_SIZE = "lut_grid_size"
+
+CONF_COALESCE = "coalesce"
+CONF_FRAME_INTERVAL = "frame_interval"
+CONF_OFFLOAD = "offload"
+CONF_RENDER_RATE = "render_rate"
+CONF_SKIP_DELTA_E = "skip_delta_e"
+
+CONF_ASYNC_WRITE = "async_write"
+CONF_ASYNC_WRITE_BUDGET = "write_budget"
+
+CONF_COMMAND_TRACE = "command_trace"
+CONF_COMMAND_TRACE_CAPACITY = "capacity"
+
 CONF_XY_OUTPUT_TYPE__RGB = "rgb"
 CONF_XY_OUTPUT_TYPE__RGB_CWWW = "rgb_cwww"
 CONF_XY_OUTPUT_TYPE__RGBW = "rgbw"
@@ -72,14 +103,93 @@ CONTROL_TYPES = {
     "W": ControlType.BRIGHTNESS,
 }
 
+BLEND_MODES = {
+    "ADD": BlendMode.ADD,
+    "MAX": BlendMode.MAX,
+    "OVER": BlendMode.OVER,
+}
+
+LAYER_CONFIG_SCHEMA = cv.Schema({
+    cv.Optional(CONF_LAYER_BLEND_MODE, default="ADD"): cv.enum(BLEND_MODES, upper=True),
+    cv.Optional(CONF_LAYER_WEIGHT, default="100%"): cv.percentage,
+})
+
 CONTROL_CONFIG_SCHEMA = cv.All(
     light.RGB_LIGHT_SCHEMA.extend({
         cv.GenerateID(CONF_XY_LIGHT_CONTROL_ID): cv.declare_id(XyLightControl),
         cv.Required(CONF_CONTROL_TYPE): cv.enum(CONTROL_TYPES, upper=True, space="_"),
         cv.Optional(CONF_CONTROL_TEMPERATURE_RANGE): xy_cv.ct_range,
+        cv.Optional(CONF_LAYER): LAYER_CONFIG_SCHEMA,
     })
 )
 
+COMMAND_TRACE_CONFIG_SCHEMA = cv.Schema({
+    cv.GenerateID(CONF_ID): cv.declare_id(CommandTrace),
+    cv.Optional(CONF_COMMAND_TRACE_CAPACITY, default=512): cv.int_range(min=1, max=8192),
+}).extend(cv.COMPONENT_SCHEMA)
+
+ASYNC_WRITE_CONFIG_SCHEMA = cv.Schema({
+    cv.GenerateID(CONF_ID): cv.declare_id(AsyncFrameWriter),
+    cv.Optional(CONF_ASYNC_WRITE_BUDGET, default="2ms"): cv.positive_time_period_microseconds,
+}).extend(cv.COMPONENT_SCHEMA)
+
+# Channels of each output type, for the size of their LUTs. Outputs referenced by id are assumed to be the largest.
+LUT_CHANNELS = {
+    CONF_XY_OUTPUT_TYPE__RGB: 3,
+    CONF_XY_OUTPUT_TYPE__RGB_CWWW: 5,
+    CONF_XY_OUTPUT_TYPE__RGBW: 4,
+    CONF_XY_OUTPUT_TYPE__CWWW: 2,
+    CONF_XY_OUTPUT_TYPE__W: 1,
+    CONF_XY_OUTPUT_TYPE__ID: 5,
+}
+
+
+def final_validate_lut_memory(config):
+    if CONF_LUT_GRID_SIZE not in config:
+        return config
+
+    limit = xy_cv.table_memory_limit()
+    grid_size = config[CONF_LUT_GRID_SIZE]
+    channels = sum(LUT_CHANNELS[key] for output in config.get(CONF_XY_OUTPUTS, []) for key in output)
+    memory = grid_size ** 3 * channels * 2
+    if limit is not None and memory > limit:
+        raise cv.Invalid(
+            f"lut_grid_size {grid_size} needs {memory // 1024}KB for this light's outputs, more than the "
+            f"{limit // 1024}KB allowed on this platform. Use a smaller grid (or add psram on ESP32s).",
+            path=[CONF_LUT_GRID_SIZE])
+    return config
+
+
+def final_validate_offload(config):
+    # The profiler's histograms are shared by every light, and would be written from both tasks
+    if config.get(CONF_OFFLOAD) and "xy_light_profiler" in fv.full_config.get():
+        raise cv.Invalid("offload can not be used with xy_light_profiler", path=[CONF_OFFLOAD])
+    return config
+
+
+FINAL_VALIDATE_SCHEMA = cv.All(final_validate_lut_memory, final_validate_offload)
+
+# Each output hands the worker one frame per render, and a whole render has to fit in its frame queue
+MAX_OFFLOADED_OUTPUTS = 14
+
+
+def validate_offload(config):
+    if not config.get(CONF_OFFLOAD):
+        return config
+
+    if any(CONF_LAYER in c for c in config[CONF_CONTROLS]):
+        raise cv.Invalid("offload can not be used with control layers")
+    if len(config.get(CONF_XY_OUTPUTS, [])) > MAX_OFFLOADED_OUTPUTS:
+        raise cv.Invalid(f"offload supports at most {MAX_OFFLOADED_OUTPUTS} outputs per light")
+
+    # Calibration samples are queued from a single task, which is the loop
+    outputs = [o for output in config.get(CONF_XY_OUTPUTS, []) for o in output.values() if isinstance(o, dict)]
+    if config.get(CONF_XY_OUTPUT_CALIBRATION_LOGGING) or any(
+            o.get(CONF_XY_OUTPUT_CALIBRATION_LOGGING) for o in outputs):
+        raise cv.Invalid("offload can not be used with calibration_logging")
+    return config
+
+
 CONFIG_SCHEMA = cv.All(
     cv.COMPONENT_SCHEMA.extend({
         cv.GenerateID(CONF_ID): cv.declare_id(XyLightOutput),
@@ -87,15 +197,41 @@ CONFIG_SCHEMA = cv.All(
         cv.Optional(CONF_SOURCE_COLOR_PROFILE): RGB_PROFILE_CONFIG_SCHEMA,
         cv.Required(CONF_CONTROLS): cv.ensure_list(CONTROL_CONFIG_SCHEMA),
         cv.Optional(CONF_XY_OUTPUTS): cv.ensure_list(XY_OUTPUT_TYPE_VARIANT_SCHEMA),
-        cv.Optional(CONF_XY_OUTPUT_CALIBRATION_LOGGING): cv.boolean
+        cv.Optional(CONF_XY_OUTPUT_CALIBRATION_LOGGING): cv.boolean,
+        cv.Optional(CONF_FIXED_POINT): cv.boolean,
+        cv.Optional(CONF_LUT_GRID_SIZE): cv.one_of(9, 17, 33, int=True),
+        cv.Optional(CONF_COMMAND_TRACE): COMMAND_TRACE_CONFIG_SCHEMA,
+        cv.Optional(CONF_COALESCE, default=True): cv.boolean,
+        cv.Optional(CONF_FRAME_INTERVAL): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_OFFLOAD): cv.boolean,
+        cv.Optional(CONF_RENDER_RATE): cv.All(cv.frequency, cv.Range(min=10, max=500)),
+        cv.Optional(CONF_SKIP_DELTA_E): cv.positive_float,
+        cv.Optional(CONF_ASYNC_WRITE): ASYNC_WRITE_CONFIG_SCHEMA,
     }),
-    cv.has_at_most_one_key(CONF_SOURCE_COLOR_PROFILE_ID, CONF_SOURCE_COLOR_PROFILE)
+    cv.has_at_most_one_key(CONF_SOURCE_COLOR_PROFILE_ID, CONF_SOURCE_COLOR_PROFILE),
+    validate_offload
 )
 
-async def to_control_code(config, var_light_output):
+async def to_render_worker_code(var_light_output):
+    # Every offloaded light shares one worker task
+    worker = cg.RawExpression("esphome::xy_light::RenderWorker::instance()")
+    cg.add(var_light_output.set_render_worker(worker))
+
+    if CORE.data.setdefault("xy_light", {}).get("render_worker"):
+        return
+    CORE.data["xy_light"]["render_worker"] = True
+    cg.add(cg.App.register_component(worker))
+
+
+async def to_control_code(config, var_light_output, layered):
     var_light_control = cg.new_Pvariable(config[CONF_XY_LIGHT_CONTROL_ID])
     cg.add(var_light_control.set_xy_light_output(var_light_output))
 
+    if layered:
+        # Once any control is a layer they all are, as the light no longer has a single colour to share
+        layer = config.get(CONF_LAYER, LAYER_CONFIG_SCHEMA({}))
+        cg.add(var_light_control.set_layer(layer[CONF_LAYER_BLEND_MODE], layer[CONF_LAYER_WEIGHT]))
+
     if CONF_CONTROL_TEMPERATURE_RANGE in config:
         ct_range = config[CONF_CONTROL_TEMPERATURE_RANGE]
         cg.add(var_light_control.set_color_temperature_range(ct_range[0], ct_range[1]))
@@ -109,6 +245,19 @@ async def to_control_code(config, var_light_output):
 
 async def to_code(config):
     var_light_output = cg.new_Pvariable(config[CONF_ID])
+    await cg.register_component(var_light_output, config)
+
+    if config[CONF_COALESCE]:
+        cg.add(var_light_output.enable_coalescing(True))
+
+    if CONF_FRAME_INTERVAL in config:
+        cg.add(var_light_output.set_frame_interval(config[CONF_FRAME_INTERVAL]))
+
+    if CONF_RENDER_RATE in config:
+        cg.add(var_light_output.set_render_rate(config[CONF_RENDER_RATE]))
+
+    if CONF_SKIP_DELTA_E in config:
+        cg.add(var_light_output.set_skip_delta_e(config[CONF_SKIP_DELTA_E]))
 
     if CONF_SOURCE_COLOR_PROFILE_ID in config:
         profile = await cg.get_variable(config[CONF_SOURCE_COLOR_PROFILE_ID])
@@ -119,18 +268,50 @@ async def to_code(config):
         inline_profile = await cg.get_variable(config[CONF_SOURCE_COLOR_PROFILE][CONF_ID])
         cg.add(var_light_output.set_source_color_profile(inline_profile))
 
+    if CONF_SOURCE_COLOR_PROFILE_ID not in config and CONF_SOURCE_COLOR_PROFILE not in config:
+        # Lights default to sRGB
+        (r_xy, g_xy, b_xy, w_xy) = STANDARD_PROFILE_CHROMATICITIES[CONF_PROFILE_STANDARD_PROFILE__SRGB]
+        (RGB2XYZ, XYZ2RGB) = to_transform_matrices_expressions(r_xy, g_xy, b_xy, w_xy)
+        cg.add(var_light_output.set_source_transform_matrices(RGB2XYZ, XYZ2RGB))
+
     if CONF_XY_OUTPUT_CALIBRATION_LOGGING in config:     
         enable_cal_log = config[CONF_XY_OUTPUT_CALIBRATION_LOGGING]
         if enable_cal_log:
-            cg.add(var_light_output.enable_calibration_logging(True))    
+            await to_calibration_logging_code(var_light_output)
+
+    if CONF_FIXED_POINT in config:
+        if config[CONF_FIXED_POINT]:
+            cg.add(var_light_output.enable_fixed_point(True))
+
+    if CONF_LUT_GRID_SIZE in config:
+        cg.add(var_light_output.set_lut_grid_size(config[CONF_LUT_GRID_SIZE]))
+
+    if CONF_COMMAND_TRACE in config:
+        trace_config = config[CONF_COMMAND_TRACE]
+        var_trace = cg.new_Pvariable(trace_config[CONF_ID])
+        cg.add(var_trace.set_capacity(trace_config[CONF_COMMAND_TRACE_CAPACITY]))
+        await cg.register_component(var_trace, trace_config)
+        cg.add(var_light_output.set_command_trace(var_trace))
 
     if CONF_XY_OUTPUTS in config:
         for output in config[CONF_XY_OUTPUTS]:
             await to_xy_output_code(var_light_output, output)
 
+    # Before offloading, so the worker hands its frames to the mailboxes
+    if CONF_ASYNC_WRITE in config:
+        writer_config = config[CONF_ASYNC_WRITE]
+        var_writer = cg.new_Pvariable(writer_config[CONF_ID])
+        cg.add(var_writer.set_write_budget(writer_config[CONF_ASYNC_WRITE_BUDGET]))
+        await cg.register_component(var_writer, writer_config)
+        cg.add(var_light_output.set_async_writer(var_writer))
+
+    if config.get(CONF_OFFLOAD):
+        await to_render_worker_code(var_light_output)
+
     if CONF_CONTROLS in config:
+        layered = any(CONF_LAYER in c for c in config[CONF_CONTROLS])
         for control_config in config[CONF_CONTROLS]:
-            await to_control_code(control_config, var_light_output)
+            await to_control_code(control_config, var_light_output, layered)
 
 async def register_xy_light_(var_light_control, config):
     light_var = cg.new_Pvariable(config[CONF_ID], var_light_control)
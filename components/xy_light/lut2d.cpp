@@ -0,0 +1,48 @@
+#include "esphome/components/xy_light/lut2d.h"
+
+using namespace esphome::xy_light;
+
+Lut2d::Lut2d(uint8_t grid_size, float u_min, float u_max, float v_min, float v_max)
+    : _grid_size(grid_size < 2 ? 2 : grid_size), _u_min(u_min), _v_min(v_min) {
+  this->_u_step = (u_max - u_min) / (float) (this->_grid_size - 1);
+  this->_v_step = (v_max - v_min) / (float) (this->_grid_size - 1);
+  this->_values.resize((size_t) this->_grid_size * this->_grid_size * MAX_CHANNELS);
+}
+
+void Lut2d::set(size_t i, size_t j, const float *values) {
+  auto *p = &this->_values[this->index(i, j)];
+  for (uint8_t c = 0; c < MAX_CHANNELS; c++) {
+    p[c] = values[c];
+  }
+}
+
+bool Lut2d::lookup(float u, float v, float *values) const {
+  auto last = (float) (this->_grid_size - 1);
+  auto x = (u - this->_u_min) / this->_u_step;
+  auto y = (v - this->_v_min) / this->_v_step;
+
+  // Note: negated compare so NaN is also outside
+  if (!(x >= 0.0f && x <= last && y >= 0.0f && y <= last))
+    return false;
+
+  auto i = (size_t) x;
+  auto j = (size_t) y;
+  if (i >= (size_t) last)
+    i = this->_grid_size - 2;
+  if (j >= (size_t) last)
+    j = this->_grid_size - 2;
+
+  auto fx = x - (float) i;
+  auto fy = y - (float) j;
+  auto *p00 = &this->_values[this->index(i, j)];
+  auto *p01 = &this->_values[this->index(i, j + 1)];
+  auto *p10 = &this->_values[this->index(i + 1, j)];
+  auto *p11 = &this->_values[this->index(i + 1, j + 1)];
+
+  for (uint8_t c = 0; c < MAX_CHANNELS; c++) {
+    auto v0 = p00[c] + ((p01[c] - p00[c]) * fy);
+    auto v1 = p10[c] + ((p11[c] - p10[c]) * fy);
+    values[c] = v0 + ((v1 - v0) * fx);
+  }
+  return true;
+}
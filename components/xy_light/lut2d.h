@@ -0,0 +1,42 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace esphome {
+namespace xy_light {
+
+// 2D lookup table over a rectangle of chromaticities (ie CIE 1960 uv), with bilinear interpolation
+class Lut2d {
+ public:
+  static const uint8_t MAX_CHANNELS = 2;
+
+  Lut2d() {}
+  Lut2d(uint8_t grid_size, float u_min, float u_max, float v_min, float v_max);
+
+  uint8_t grid_size() const { return this->_grid_size; }
+
+  // Chromaticity of the given grid point, ie where the table should be sampled
+  float grid_u(size_t i) const { return this->_u_min + ((float) i * this->_u_step); }
+  float grid_v(size_t j) const { return this->_v_min + ((float) j * this->_v_step); }
+
+  void set(size_t i, size_t j, const float *values);
+
+  // False when u, v is outside of the table
+  bool lookup(float u, float v, float *values) const;
+
+  size_t memory_usage() const { return this->_values.size() * sizeof(float); }
+
+ protected:
+  uint8_t _grid_size = 0;
+  float _u_min = 0.0f;
+  float _v_min = 0.0f;
+  float _u_step = 0.0f;
+  float _v_step = 0.0f;
+  std::vector<float> _values;
+
+  size_t index(size_t i, size_t j) const { return ((i * this->_grid_size) + j) * MAX_CHANNELS; }
+};
+
+}  // namespace xy_light
+}  // namespace esphome
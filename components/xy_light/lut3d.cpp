@@ -0,0 +1,75 @@
+#include "esphome/components/xy_light/lut3d.h"
+
+using namespace esphome::xy_light;
+
+Lut3d::Lut3d(uint8_t grid_size, uint8_t channels)
+    : _grid_size(grid_size < 2 ? 2 : grid_size), _channels(channels > MAX_CHANNELS ? MAX_CHANNELS : channels) {
+  this->_values.resize((size_t) this->_grid_size * this->_grid_size * this->_grid_size * this->_channels);
+  this->_encode = color_space::TransferFunction::exp_gamma_compress(ENCODING_GAMMA);
+}
+
+float Lut3d::grid_value(size_t i) const {
+  return color_space::exp_gamma_decompress((float) i / (float) (this->_grid_size - 1), ENCODING_GAMMA);
+}
+
+void Lut3d::set(size_t r, size_t g, size_t b, const float *levels) {
+  auto *values = &this->_values[this->index(r, g, b)];
+  for (uint8_t c = 0; c < this->_channels; c++) {
+    auto v = levels[c] <= 0.0f ? 0.0f : (levels[c] >= 1.0f ? 1.0f : levels[c]);
+    values[c] = (uint16_t) lroundf(v * 65535.0f);
+  }
+}
+
+void Lut3d::lookup(float r, float g, float b, float *levels) const {
+  auto last = this->_grid_size - 1;
+
+  // Position in the grid, split into the cell and the fraction within it
+  float p[3] = {this->_encode(r), this->_encode(g), this->_encode(b)};
+  size_t i[3];
+  float f[3];
+  for (int c = 0; c < 3; c++) {
+    auto x = p[c] <= 0.0f ? 0.0f : (p[c] >= 1.0f ? (float) last : p[c] * (float) last);
+    i[c] = (size_t) x;
+    if (i[c] >= (size_t) last)
+      i[c] = last - 1;
+    f[c] = x - (float) i[c];
+  }
+
+  // The cell is split into 6 tetrahedra along its r = g = b diagonal, find the one the point is in from
+  // the order of its fractions. Each is then walked from the (0, 0, 0) corner, one axis at a time.
+  int order[3];
+  if (f[0] >= f[1]) {
+    if (f[1] >= f[2]) {
+      order[0] = 0, order[1] = 1, order[2] = 2;
+    } else if (f[0] >= f[2]) {
+      order[0] = 0, order[1] = 2, order[2] = 1;
+    } else {
+      order[0] = 2, order[1] = 0, order[2] = 1;
+    }
+  } else {
+    if (f[2] >= f[1]) {
+      order[0] = 2, order[1] = 1, order[2] = 0;
+    } else if (f[2] >= f[0]) {
+      order[0] = 1, order[1] = 2, order[2] = 0;
+    } else {
+      order[0] = 1, order[1] = 0, order[2] = 2;
+    }
+  }
+
+  size_t corner[3] = {i[0], i[1], i[2]};
+  auto *v0 = &this->_values[this->index(corner[0], corner[1], corner[2])];
+  corner[order[0]]++;
+  auto *v1 = &this->_values[this->index(corner[0], corner[1], corner[2])];
+  corner[order[1]]++;
+  auto *v2 = &this->_values[this->index(corner[0], corner[1], corner[2])];
+  auto *v3 = &this->_values[this->index(i[0] + 1, i[1] + 1, i[2] + 1)];
+
+  auto w0 = 1.0f - f[order[0]];
+  auto w1 = f[order[0]] - f[order[1]];
+  auto w2 = f[order[1]] - f[order[2]];
+  auto w3 = f[order[2]];
+
+  for (uint8_t c = 0; c < this->_channels; c++) {
+    levels[c] = ((w0 * v0[c]) + (w1 * v1[c]) + (w2 * v2[c]) + (w3 * v3[c])) * (1.0f / 65535.0f);
+  }
+}
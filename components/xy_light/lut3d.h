@@ -0,0 +1,47 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "esphome/components/xy_light/transfer_function.h"
+
+namespace esphome {
+namespace xy_light {
+
+// 3D lookup table from linear RGB to up to MAX_CHANNELS output levels, using tetrahedral interpolation.
+// Grid points are spaced evenly after a 1/2.2 power encoding (rather than in linear light), so that the
+// resolution of the table follows the eye's sensitivity. Levels are stored as 16 bit values.
+class Lut3d {
+ public:
+  static const uint8_t MAX_CHANNELS = 5;
+  static constexpr float ENCODING_GAMMA = 2.2f;
+
+  Lut3d() {}
+  Lut3d(uint8_t grid_size, uint8_t channels);
+
+  uint8_t grid_size() const { return this->_grid_size; }
+  uint8_t channels() const { return this->_channels; }
+
+  // Linear value of the given grid index, ie where the table should be sampled
+  float grid_value(size_t i) const;
+
+  void set(size_t r, size_t g, size_t b, const float *levels);
+
+  // r, g and b are linear values in [0, 1]
+  void lookup(float r, float g, float b, float *levels) const;
+
+  size_t memory_usage() const { return this->_values.size() * sizeof(uint16_t); }
+
+ protected:
+  uint8_t _grid_size = 0;
+  uint8_t _channels = 0;
+  std::vector<uint16_t> _values;
+  color_space::TransferFunction _encode;
+
+  size_t index(size_t r, size_t g, size_t b) const {
+    return (((r * this->_grid_size) + g) * this->_grid_size + b) * this->_channels;
+  }
+};
+
+}  // namespace xy_light
+}  // namespace esphome
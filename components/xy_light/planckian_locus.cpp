@@ -0,0 +1,80 @@
+#include "esphome/components/xy_light/planckian_locus.h"
+
+#include <algorithm>
+
+using namespace esphome::xy_light::color_space;
+
+namespace {
+// Generated at compile time, so lives in flash (.rodata) rather than being built on boot
+constexpr planckian_locus::LocusTable LOCUS_TABLE = planckian_locus::generate_table();
+}  // namespace
+
+LocusPoint PlanckianLocus::at_mired(float mired) {
+  // Note: negated compare so NaN also takes the direct evaluation path
+  if (!(mired >= planckian_locus::MIN_MIRED && mired <= planckian_locus::MAX_MIRED)) {
+    return planckian_locus::evaluate<float>(mired);
+  }
+
+  auto pos = (mired - planckian_locus::MIN_MIRED) * (1.0f / planckian_locus::MIRED_STEP);
+  auto i = (size_t) pos;
+  if (i >= planckian_locus::TABLE_SIZE - 1)
+    i = planckian_locus::TABLE_SIZE - 2;
+
+  auto f = pos - (float) i;
+  auto &p0 = LOCUS_TABLE.points[i];
+  auto &p1 = LOCUS_TABLE.points[i + 1];
+
+  // The interpolated tangent is not re-normalised, adjacent tangents differ by so little
+  // that the length error is well under 1e-3
+  return {p0.u + ((p1.u - p0.u) * f), p0.v + ((p1.v - p0.v) * f), p0.tangent_u + ((p1.tangent_u - p0.tangent_u) * f),
+          p0.tangent_v + ((p1.tangent_v - p0.tangent_v) * f)};
+}
+
+CctDuv PlanckianLocus::solve(float u, float v) {
+  auto &points = LOCUS_TABLE.points;
+
+  // Signed distance along the locus tangent from the isotemperature line through point i.
+  // This decreases monotonically with i, crossing zero at the value's colour temperature.
+  auto iso_dist = [&](size_t i) {
+    return ((u - points[i].u) * points[i].tangent_u) + ((v - points[i].v) * points[i].tangent_v);
+  };
+
+  // Signed distance along the locus normal, positive being above the locus (green tint)
+  auto normal_dist = [&](size_t i) {
+    return ((v - points[i].v) * points[i].tangent_u) - ((u - points[i].u) * points[i].tangent_v);
+  };
+
+  size_t lo = 0;
+  size_t hi = planckian_locus::TABLE_SIZE - 1;
+  auto lo_dist = iso_dist(lo);
+  auto hi_dist = iso_dist(hi);
+
+  // Note: negated compare so NaN is also rejected. Values on the table's end points may round to just outside them.
+  if (!(lo_dist >= -planckian_locus::END_TOLERANCE && hi_dist <= planckian_locus::END_TOLERANCE && lo_dist > hi_dist)) {
+    return {0.0f, 0.0f, false};
+  }
+
+  while (hi - lo > 1) {
+    auto mid = (lo + hi) / 2;
+    auto mid_dist = iso_dist(mid);
+    if (mid_dist >= 0.0f) {
+      lo = mid;
+      lo_dist = mid_dist;
+    } else {
+      hi = mid;
+      hi_dist = mid_dist;
+    }
+  }
+
+  auto f = std::min(std::max(lo_dist / (lo_dist - hi_dist), 0.0f), 1.0f);
+  auto mired = planckian_locus::MIN_MIRED + (((float) lo + f) * planckian_locus::MIRED_STEP);
+
+  auto lo_duv = normal_dist(lo);
+  auto duv = lo_duv + ((normal_dist(hi) - lo_duv) * f);
+
+  bool valid = mired >= planckian_locus::MIN_VALID_MIRED - planckian_locus::MIRED_TOLERANCE &&
+               mired <= planckian_locus::MAX_VALID_MIRED + planckian_locus::MIRED_TOLERANCE &&
+               duv <= planckian_locus::DUV_LIMIT && duv >= -planckian_locus::DUV_LIMIT;
+
+  return {mired, duv, valid};
+}
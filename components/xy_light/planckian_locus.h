@@ -0,0 +1,170 @@
+#pragma once
+#include <stddef.h>
+
+namespace esphome {
+namespace xy_light {
+namespace color_space {
+
+// A point on the Planckian locus in CIE 1960 uv, along with the unit tangent of the locus at that point.
+// The tangent points in the direction of increasing mired (ie warmer), which makes the unit normal
+// pointing towards positive delta uv (green tint) equal to (-tangent_v, tangent_u).
+struct LocusPoint {
+  float u;
+  float v;
+  float tangent_u;
+  float tangent_v;
+};
+
+// Correlated colour temperature and distance from the Planckian locus of a uv value.
+// valid is false when the value lays outside the region where the isotemperature lines are meaningful
+// (beyond 1000K - 20000K or further than DUV_LIMIT from the locus), in which case mired and duv should not be used.
+struct CctDuv {
+  float mired;
+  float duv;
+  bool valid;
+};
+
+namespace planckian_locus {
+
+// Krystek, M. (1985). An algorithm to calculate correlated colour
+//        temperature. Color Research & Application, 10(1), 38–40.
+//        doi:10.1002/col.5080100109
+//
+// Re-parameterised in mired (numerator and denominator multiplied through by mired^2) so that the locus
+// remains well defined all the way to infinite colour temperature (0 mired).
+// Each coefficient set is {mired^2, mired, constant} for the numerator and denominator.
+template<typename T> struct Rational {
+  T value;
+  T derivative;
+};
+
+template<typename T>
+constexpr Rational<T> eval_rational(T m, T n2, T n1, T n0, T d2, T d1, T d0) {
+  return {((n2 * m * m) + (n1 * m) + n0) / ((d2 * m * m) + (d1 * m) + d0),
+          ((((2 * n2 * m) + n1) * ((d2 * m * m) + (d1 * m) + d0)) -
+           (((n2 * m * m) + (n1 * m) + n0) * ((2 * d2 * m) + d1))) /
+              (((d2 * m * m) + (d1 * m) + d0) * ((d2 * m * m) + (d1 * m) + d0))};
+}
+
+template<typename T> constexpr Rational<T> krystek_u(T m) {
+  return eval_rational<T>(m, T(0.860117757), T(154.118254), T(128641.212),  //
+                          T(1.0), T(842.420235), T(708145.163));
+}
+
+template<typename T> constexpr Rational<T> krystek_v(T m) {
+  return eval_rational<T>(m, T(0.317398726), T(42.2806245), T(42048.1691),  //
+                          T(1.0), T(-28.9741816), T(161456.053));
+}
+
+template<typename T> constexpr T sqrt_newton(T x) {
+  T r = x > T(1) ? x : T(1);
+  for (int i = 0; i < 64; i++) {
+    r = (r + (x / r)) / T(2);
+  }
+  return r;
+}
+
+template<typename T> constexpr LocusPoint evaluate(T m) {
+  auto u = krystek_u<T>(m);
+  auto v = krystek_v<T>(m);
+  auto l = sqrt_newton<T>((u.derivative * u.derivative) + (v.derivative * v.derivative));
+  return {float(u.value), float(v.value), float(u.derivative / l), float(v.derivative / l)};
+}
+
+// Table covers 0 mired (infinite K) to 1000 mired (1000K) in 5 mired steps (201 points, ~3.2KB of flash).
+// Linear interpolation between points stays within 1e-5 uv of the Krystek approximation.
+static constexpr float MIN_MIRED = 0.0f;
+static constexpr float MAX_MIRED = 1000.0f;
+static constexpr float MIRED_STEP = 5.0f;
+static constexpr size_t TABLE_SIZE = 201;
+
+// Region in which CCT / Duv values are considered valid
+static constexpr float MIN_VALID_MIRED = 50.0f;
+static constexpr float MAX_VALID_MIRED = 1000.0f;
+static constexpr float DUV_LIMIT = 0.09f;
+// Solved values within the solver's error of the valid range are taken as in it, so its ends are valid
+static constexpr float MIRED_TOLERANCE = 0.05f;
+// Distance from the table's end points' isotemperature lines (uv) still taken as on them
+static constexpr float END_TOLERANCE = 1e-6f;
+
+struct LocusTable {
+  LocusPoint points[TABLE_SIZE];
+};
+
+constexpr LocusTable generate_table() {
+  LocusTable table{};
+  for (size_t i = 0; i < TABLE_SIZE; i++) {
+    table.points[i] = evaluate<double>(double(MIN_MIRED) + (double(MIRED_STEP) * double(i)));
+  }
+  return table;
+}
+
+// Polygon enclosing the region where delta uv is meaningful, made of points DUV_LIMIT either side
+// of the locus at a handful of colour temperatures. Green side first in order of the colour temperatures,
+// followed by the purple side in reverse to close the loop.
+static constexpr double DUV_REGION_KELVIN[] = {1000.0, 1600.0, 2000.0, 2500.0,  3000.0,  4000.0, 5000.0,
+                                               6000.0, 7000.0, 8000.0, 10000.0, 15000.0, 20000.0};
+static constexpr size_t DUV_REGION_KELVIN_COUNT = sizeof(DUV_REGION_KELVIN) / sizeof(DUV_REGION_KELVIN[0]);
+static constexpr size_t DUV_REGION_EDGE_COUNT = DUV_REGION_KELVIN_COUNT * 2;
+
+// Polygon edge from vertex a to b, with the slope precomputed so point in polygon tests need no division
+struct DuvRegionEdge {
+  float a_u;
+  float a_v;
+  float b_v;
+  float du_dv;
+};
+
+struct DuvRegion {
+  DuvRegionEdge edges[DUV_REGION_EDGE_COUNT];
+};
+
+constexpr DuvRegion generate_duv_region() {
+  double u[DUV_REGION_EDGE_COUNT] = {};
+  double v[DUV_REGION_EDGE_COUNT] = {};
+
+  for (size_t i = 0; i < DUV_REGION_KELVIN_COUNT; i++) {
+    auto p = evaluate<double>(1000000.0 / DUV_REGION_KELVIN[i]);
+    auto green = i;
+    auto purple = DUV_REGION_EDGE_COUNT - 1 - i;
+
+    // Normal is (-tangent_v, tangent_u)
+    u[green] = p.u - (DUV_LIMIT * p.tangent_v);
+    v[green] = p.v + (DUV_LIMIT * p.tangent_u);
+    u[purple] = p.u + (DUV_LIMIT * p.tangent_v);
+    v[purple] = p.v - (DUV_LIMIT * p.tangent_u);
+  }
+
+  DuvRegion region{};
+  for (size_t a = 0; a < DUV_REGION_EDGE_COUNT; a++) {
+    // take the last vertex for the first edge to complete the "loop"
+    auto b = a == 0 ? DUV_REGION_EDGE_COUNT - 1 : a - 1;
+    auto dv = v[b] - v[a];
+    region.edges[a] = {float(u[a]), float(v[a]), float(v[b]), float(dv != 0.0 ? (u[b] - u[a]) / dv : 0.0)};
+  }
+  return region;
+}
+
+}  // namespace planckian_locus
+
+class PlanckianLocus {
+ public:
+  // Interpolated locus point for the given mired. Values outside of the table range are evaluated directly.
+  static LocusPoint at_mired(float mired);
+
+  static LocusPoint at_kelvin(float kelvin) { return PlanckianLocus::at_mired(1000000.0f / kelvin); }
+
+  // Robertson style CCT and Duv solver, using the table's tangents as isotemperature lines.
+  // Binary searches for the pair of isotemperature lines either side of the uv value, then interpolates
+  // mired and Duv between them. No transcendental functions are used.
+  static CctDuv solve(float u, float v);
+
+  // A requested colour temperature, which by definition lies on the locus
+  static CctDuv on_locus(float mired) {
+    return {mired, 0.0f, mired >= planckian_locus::MIN_VALID_MIRED && mired <= planckian_locus::MAX_VALID_MIRED};
+  }
+};
+
+}  // namespace color_space
+}  // namespace xy_light
+}  // namespace esphome
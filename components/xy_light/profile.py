@@ -55,6 +55,7 @@ CONF_PROFILE_PURPLE_TINT_IMPURITY = "purple_tint_impurity"
 CONF_PROFILE_IMPURITY_GAMMA_DECAY = "impurity_gamma_decay"
 CONF_PROFILE_RED_CCT_IMPURITY = "red_cct_impurity"
 CONF_PROFILE_BLUE_CCT_IMPURITY = "blue_cct_impurity"
+CONF_PROFILE_UV_LUT_GRID_SIZE = "uv_lut_grid_size"
 
 CONF_PROFILE_MAX_WARM_WHITE_INTENSITY = "max_warm_white_intensity"
 CONF_PROFILE_MAX_COLD_WHITE_INTENSITY = "max_cold_white_intensity"
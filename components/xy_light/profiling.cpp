@@ -0,0 +1,101 @@
+#include "esphome/components/xy_light/profiling.h"
+
+#ifdef USE_XY_LIGHT_PROFILING
+
+using namespace esphome::xy_light;
+
+uint8_t TickHistogram::bucket(uint32_t ticks) {
+  if (ticks < 16)
+    return (uint8_t) ticks;
+
+  // Index of the leading bit (4 to 31), then the 3 bits below it
+  uint8_t e = 31 - __builtin_clz(ticks);
+  return (uint8_t) (16 + ((e - 4) * 8) + ((ticks >> (e - 3)) & 7));
+}
+
+uint32_t TickHistogram::bucket_low(uint8_t bucket) {
+  if (bucket < 16)
+    return bucket;
+
+  uint8_t e = ((bucket - 16) / 8) + 4;
+  uint32_t m = (bucket - 16) % 8;
+  return (uint32_t(1) << e) + (m << (e - 3));
+}
+
+void TickHistogram::add(uint32_t ticks) {
+  auto &b = this->_buckets[bucket(ticks)];
+  if (b == UINT16_MAX) {
+    // Halve everything rather than saturate, so the shape (and so the percentiles) are kept
+    for (auto &other : this->_buckets) {
+      other /= 2;
+    }
+  }
+  b++;
+
+  this->_count++;
+  if (ticks < this->_min)
+    this->_min = ticks;
+  if (ticks > this->_max)
+    this->_max = ticks;
+}
+
+void TickHistogram::reset() {
+  for (auto &b : this->_buckets) {
+    b = 0;
+  }
+  this->_count = 0;
+  this->_min = UINT32_MAX;
+  this->_max = 0;
+}
+
+uint32_t TickHistogram::percentile(float p) const {
+  uint32_t total = 0;
+  for (auto b : this->_buckets) {
+    total += b;
+  }
+  if (total == 0)
+    return 0;
+
+  auto target = (uint32_t) (p * (float) total);
+  uint32_t seen = 0;
+  for (uint8_t i = 0; i < BUCKET_COUNT; i++) {
+    seen += this->_buckets[i];
+    if (seen > target) {
+      auto low = bucket_low(i);
+      auto high = i + 1 < BUCKET_COUNT ? bucket_low(i + 1) : this->_max;
+      // Keep within the values actually seen
+      auto mid = low + ((high - low) / 2);
+      return mid < this->min() ? this->min() : (mid > this->_max ? this->_max : mid);
+    }
+  }
+  return this->_max;
+}
+
+float StageProfiler::ticks_to_us(uint32_t ticks) {
+#ifdef USE_HOST
+  return (float) ticks / 1000.0f;
+#else
+  return (float) ticks / ((float) arch_get_cpu_freq_hz() / 1000000.0f);
+#endif
+}
+
+const char *StageProfiler::stage_name(ProfileStage stage) {
+  switch (stage) {
+    case PROFILE_DECODE:
+      return "decode";
+    case PROFILE_SATURATION:
+      return "saturation";
+    case PROFILE_WHITE_BALANCE:
+      return "white_balance";
+    case PROFILE_OUTPUT_TRANSFORM:
+      return "output_transform";
+    case PROFILE_CALIBRATION:
+      return "calibration";
+    case PROFILE_COMMIT:
+      return "commit";
+    default:
+      return "unknown";
+  }
+}
+
+#endif
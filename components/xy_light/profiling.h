@@ -0,0 +1,128 @@
+#pragma once
+#include <stdint.h>
+
+#include "esphome/core/defines.h"
+
+// Time spent in each stage of the colour pipeline, enabled by adding the xy_light_profiler component (which defines
+// USE_XY_LIGHT_PROFILING). Otherwise XY_PROFILE_STAGE() compiles to nothing.
+#ifdef USE_XY_LIGHT_PROFILING
+
+#ifdef USE_HOST
+#include <chrono>
+#else
+#include "esphome/core/hal.h"
+#endif
+
+namespace esphome {
+namespace xy_light {
+
+enum ProfileStage : uint8_t {
+  // Source RGB to linear RGB (or XYZ in fixed point)
+  PROFILE_DECODE = 0,
+  PROFILE_SATURATION,
+  // White balance scale / matrix for a new white point
+  PROFILE_WHITE_BALANCE,
+  // Each output's colour transform, less its calibration and commit
+  PROFILE_OUTPUT_TRANSFORM,
+  // Gamma and intensity calibration of the output channels
+  PROFILE_CALIBRATION,
+  // Writing a frame of channel levels to its sink
+  PROFILE_COMMIT,
+  PROFILE_STAGE_COUNT
+};
+
+// Fixed size histogram of tick counts. Buckets are exact below 16 ticks, then 8 per power of 2 (ie within 12.5%).
+class TickHistogram {
+ public:
+  static const uint8_t BUCKET_COUNT = 16 + (28 * 8);
+
+  void add(uint32_t ticks);
+  void reset();
+
+  uint32_t count() const { return this->_count; }
+  uint32_t min() const { return this->_count ? this->_min : 0; }
+  uint32_t max() const { return this->_max; }
+  // Midpoint of the bucket holding the given fraction of samples, ie 0.99 for p99
+  uint32_t percentile(float p) const;
+
+ protected:
+  uint16_t _buckets[BUCKET_COUNT] = {};
+  uint32_t _count = 0;
+  uint32_t _min = UINT32_MAX;
+  uint32_t _max = 0;
+
+  static uint8_t bucket(uint32_t ticks);
+  static uint32_t bucket_low(uint8_t bucket);
+};
+
+// Histograms of all the pipeline stages, shared by every light
+class StageProfiler {
+ public:
+  static StageProfiler *instance() {
+    static StageProfiler profiler;
+    return &profiler;
+  }
+
+  static uint32_t now() {
+#ifdef USE_HOST
+    return (uint32_t) std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+#else
+    return arch_get_cpu_cycle_count();
+#endif
+  }
+
+  // Ticks are nanoseconds on the host, and CPU cycles on a device
+  static float ticks_to_us(uint32_t ticks);
+
+  TickHistogram &histogram(ProfileStage stage) { return this->_histograms[stage]; }
+
+  void reset() {
+    for (auto &h : this->_histograms) {
+      h.reset();
+    }
+  }
+
+  static const char *stage_name(ProfileStage stage);
+
+ protected:
+  friend class ProfileScope;
+
+  TickHistogram _histograms[PROFILE_STAGE_COUNT];
+  // Ticks of the scopes nested in the current one, so each stage is timed without the stages it calls
+  uint32_t _nested = 0;
+};
+
+class ProfileScope {
+ public:
+  explicit ProfileScope(ProfileStage stage) : _stage(stage) {
+    auto *profiler = StageProfiler::instance();
+    this->_outer_nested = profiler->_nested;
+    this->_start = StageProfiler::now();
+  }
+
+  ~ProfileScope() {
+    auto elapsed = StageProfiler::now() - this->_start;
+    auto *profiler = StageProfiler::instance();
+    auto nested = profiler->_nested - this->_outer_nested;
+    profiler->_histograms[this->_stage].add(elapsed - nested);
+    profiler->_nested = this->_outer_nested + elapsed;
+  }
+
+ protected:
+  ProfileStage _stage;
+  uint32_t _start;
+  uint32_t _outer_nested;
+};
+
+}  // namespace xy_light
+}  // namespace esphome
+
+#define XY_PROFILE_STAGE(stage) ::esphome::xy_light::ProfileScope xy_profile_scope_(::esphome::xy_light::stage)
+
+#else
+
+#define XY_PROFILE_STAGE(stage)
+
+#endif
@@ -0,0 +1,257 @@
+#include "esphome/components/xy_light/render_worker.h"
+
+#include <cinttypes>
+
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+#include "esphome/components/xy_light/xy_light.h"
+
+using namespace esphome::xy_light;
+
+static const char *const TAG = "xy_light.worker";
+
+bool RenderWorker::attach(XyLightOutput *light, const std::vector<XyOutput *> &outputs) {
+  if (outputs.size() > MAX_OUTPUTS_PER_LIGHT) {
+    ESP_LOGE(TAG, "Can not offload a light with %u outputs, at most %u", (unsigned) outputs.size(),
+             (unsigned) MAX_OUTPUTS_PER_LIGHT);
+    return false;
+  }
+
+  this->_lights.push_back(light);
+  for (auto output : outputs) {
+    this->_sinks.push_back(std::unique_ptr<DeferredFrameSink>(new DeferredFrameSink(this, output->get_frame_sink())));
+    output->set_frame_sink(this->_sinks.back().get());
+  }
+  return true;
+}
+
+void RenderWorker::post(XyLightOutput *light, const XyLightCommand &command) {
+  this->_stats.posted++;
+
+  // Commands of a light which is already waiting for space are folded in, so they are never applied out of order
+  for (auto &unposted : this->_unposted) {
+    if (unposted.light == light) {
+      unposted.command.merge(command);
+      this->_stats.merged++;
+      return;
+    }
+  }
+
+  if (!this->_commands.push({light, command})) {
+    this->_unposted.push_back({light, command});
+    this->_stats.merged++;
+  }
+
+  auto depth = (uint32_t) this->_commands.size();
+  if (depth > this->_stats.max_depth)
+    this->_stats.max_depth = depth;
+  this->wake();
+}
+
+void RenderWorker::setup() {
+  this->_running = true;
+#ifdef USE_HOST
+  this->_thread = std::thread(&RenderWorker::run, this);
+#elif defined(USE_ESP32)
+  // The loop task runs on core 1, so the pipeline gets core 0 to itself (less Wi-Fi) where there is one
+#if portNUM_PROCESSORS > 1
+  const BaseType_t core = 0;
+#else
+  const BaseType_t core = tskNO_AFFINITY;
+#endif
+  xTaskCreatePinnedToCore(&RenderWorker::run, "xy_light", 4096, this, 1, &this->_task, core);
+#endif
+}
+
+void RenderWorker::loop() {
+#if !defined(USE_HOST) && !defined(USE_ESP32)
+  // Without a worker task, render in the loop, which still folds every command of an iteration into one frame
+  this->drain();
+  this->idle();
+#endif
+
+  if (!this->_unposted.empty()) {
+    size_t kept = 0;
+    for (auto &unposted : this->_unposted) {
+      if (!this->_commands.push(unposted))
+        this->_unposted[kept++] = unposted;
+    }
+    this->_unposted.resize(kept);
+    this->wake();
+  }
+
+  this->commit_frames();
+
+  auto now = millis();
+  if (now - this->_last_stats_ms >= STATS_INTERVAL_MS && this->_stats.frames != this->_reported_frames) {
+    this->_last_stats_ms = now;
+    this->_reported_frames = this->_stats.frames;
+    ESP_LOGD(TAG, "Queue depth %u (max %" PRIu32 "), latency %.0f us mean, %" PRIu32 " us max, %" PRIu32 " frames",
+             (unsigned) this->depth(), this->_stats.max_depth, this->_stats.mean_latency_us(),
+             this->_stats.max_latency_us, this->_stats.frames);
+  }
+}
+
+void RenderWorker::commit_frames() {
+  // Sinks committed to, which are latched once the complete renders have been committed. There can be no more of
+  // them than frames in the queue.
+  XyFrameSink *latches[FRAME_CAPACITY];
+  uint8_t latch_count = 0;
+
+  auto complete = this->_frames_complete.load(std::memory_order_acquire);
+  QueuedFrame queued;
+  while (this->_frames_taken != complete && this->_frames.pop(queued)) {
+    this->_frames_taken++;
+    queued.sink->commit_frame(queued.frame);
+
+    uint8_t i = 0;
+    while (i < latch_count && latches[i] != queued.sink)
+      i++;
+    if (i == latch_count)
+      latches[latch_count++] = queued.sink;
+
+    auto latency = micros() - queued.posted_us;
+    this->_stats.frames++;
+    this->_stats.last_latency_us = latency;
+    this->_stats.total_latency_us += latency;
+    if (latency > this->_stats.max_latency_us)
+      this->_stats.max_latency_us = latency;
+  }
+
+  for (uint8_t i = 0; i < latch_count; i++) {
+    latches[i]->latch();
+  }
+}
+
+void RenderWorker::dump_config() {
+  ESP_LOGCONFIG(TAG, "XY Light Render Worker:");
+  ESP_LOGCONFIG(TAG, "  Command queue: %u, frame queue: %u", (unsigned) COMMAND_CAPACITY - 1,
+                (unsigned) FRAME_CAPACITY - 1);
+}
+
+bool RenderWorker::settled() const {
+  // The command queue is checked before _draining, which drain() sets before taking from it
+  if (!this->_unposted.empty() || !this->_commands.empty() || this->_draining)
+    return false;
+  return this->_frames_taken == this->_frames_complete.load(std::memory_order_acquire) && this->_frames.empty();
+}
+
+void RenderWorker::drain() {
+  // Lights changed by this batch of commands, each is rendered once after all of its commands are applied
+  static const uint8_t MAX_LIGHTS = 8;
+  XyLightOutput *lights[MAX_LIGHTS];
+  uint32_t posted_us[MAX_LIGHTS];
+  uint8_t count = 0;
+  this->_draining = true;
+
+  QueuedCommand queued;
+  while (this->_commands.pop(queued)) {
+    queued.light->execute(queued.command);
+
+    uint8_t i = 0;
+    while (i < count && lights[i] != queued.light)
+      i++;
+    if (i == count) {
+      if (count == MAX_LIGHTS) {
+        // Render what has been gathered so far to make room
+        for (uint8_t j = 0; j < count; j++) {
+          this->render(lights[j], posted_us[j]);
+        }
+        count = i = 0;
+      }
+      lights[count++] = queued.light;
+    }
+    posted_us[i] = queued.command.posted_us;
+  }
+
+  for (uint8_t i = 0; i < count; i++) {
+    this->render(lights[i], posted_us[i]);
+  }
+  this->_draining = false;
+}
+
+void RenderWorker::render(XyLightOutput *light, uint32_t posted_us) {
+  this->_rendering_posted_us = posted_us;
+  light->render();
+  this->_stats.renders++;
+#if !defined(USE_HOST) && !defined(USE_ESP32)
+  // Rendering in the loop, so each render is committed as soon as it is produced. The queue then only ever holds
+  // the one render, which attach() makes sure fits.
+  this->commit_frames();
+#endif
+}
+
+void RenderWorker::stop() {
+  this->_running = false;
+#ifdef USE_HOST
+  this->wake();
+  if (this->_thread.joinable())
+    this->_thread.join();
+#endif
+}
+
+void RenderWorker::push_frame(XyFrameSink *sink, const XyFrame &frame) {
+  // Frames only hold the channels which changed, so none can be dropped. Wait for the loop to make room instead
+  // (attach() makes sure a light's whole render fits, as the loop only takes whole renders).
+  while (!this->_frames.push({sink, frame, this->_rendering_posted_us})) {
+#ifdef USE_HOST
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+#elif defined(USE_ESP32)
+    vTaskDelay(1);
+#else
+    // Rendering in the loop, which commits each render as it is produced, so the loop can not make room. Should a
+    // render not fit, commit what is queued first so no sink's frames are committed out of order, then this one.
+    QueuedFrame queued;
+    while (this->_frames.pop(queued)) {
+      this->_frames_taken++;
+      queued.sink->commit_frame(queued.frame);
+    }
+    sink->commit_frame(frame);
+    return;
+#endif
+  }
+  this->_frames_pushed++;
+}
+
+void RenderWorker::idle() {
+  for (auto light : this->_lights) {
+    if (!this->_commands.empty())
+      return;
+    light->build_luts();
+  }
+}
+
+void RenderWorker::wake() {
+#ifdef USE_HOST
+  {
+    std::lock_guard<std::mutex> lock(this->_wake_mutex);
+    this->_woken = true;
+  }
+  this->_wake.notify_one();
+#elif defined(USE_ESP32)
+  if (this->_task != nullptr)
+    xTaskNotifyGive(this->_task);
+#endif
+}
+
+void RenderWorker::wait() {
+#ifdef USE_HOST
+  std::unique_lock<std::mutex> lock(this->_wake_mutex);
+  this->_wake.wait_for(lock, std::chrono::milliseconds(10), [this] { return this->_woken; });
+  this->_woken = false;
+#elif defined(USE_ESP32)
+  ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(10));
+#endif
+}
+
+void RenderWorker::run(void *param) {
+  auto *worker = static_cast<RenderWorker *>(param);
+  while (worker->_running) {
+    worker->wait();
+    worker->drain();
+    worker->idle();
+  }
+#ifdef USE_ESP32
+  vTaskDelete(nullptr);
+#endif
+}
@@ -0,0 +1,195 @@
+#pragma once
+#include <atomic>
+#include <math.h>
+#include <memory>
+#include <stdint.h>
+#include <vector>
+
+#include "esphome/core/component.h"
+#include "esphome/core/defines.h"
+#include "esphome/components/xy_light/spsc_queue.h"
+#include "esphome/components/xy_light/xy_output.h"
+
+#ifdef USE_HOST
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#elif defined(USE_ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+
+namespace esphome {
+namespace xy_light {
+
+class XyLightOutput;
+
+// The values a control sets on its light, NAN for those it does not control
+struct XyLightCommand {
+  float mired = NAN;
+  float saturation = NAN;
+  float brightness = NAN;
+  float r = NAN, g = NAN, b = NAN;
+  // micros() when the control was written, for the latency to the frame being committed
+  uint32_t posted_us = 0;
+  // Written by the light state part way through a transition, rather than a value it settles on
+  bool transitioning = false;
+
+  // Folds a later command into this one, ie when it could not be queued
+  void merge(const XyLightCommand &other) {
+    if (!std::isnan(other.mired))
+      this->mired = other.mired;
+    if (!std::isnan(other.saturation))
+      this->saturation = other.saturation;
+    if (!std::isnan(other.brightness))
+      this->brightness = other.brightness;
+    if (!std::isnan(other.r)) {
+      this->r = other.r;
+      this->g = other.g;
+      this->b = other.b;
+    }
+    this->posted_us = other.posted_us;
+    this->transitioning = other.transitioning;
+  }
+};
+
+struct RenderWorkerStats {
+  // Commands queued by the controls, and those which were folded into a later one as the queue was full
+  uint32_t posted = 0;
+  uint32_t merged = 0;
+  // Times a light was rendered by the worker, and channel frames handed back to the loop
+  uint32_t renders = 0;
+  uint32_t frames = 0;
+  // Deepest the command queue has been
+  uint32_t max_depth = 0;
+  // Control write to frame commit, over the frames committed
+  uint32_t last_latency_us = 0;
+  uint32_t max_latency_us = 0;
+  uint64_t total_latency_us = 0;
+
+  float mean_latency_us() const { return this->frames ? (float) this->total_latency_us / (float) this->frames : 0.0f; }
+};
+
+// Runs the colour pipeline of offloaded lights on a worker task (pinned to the other core on dual core ESP32s),
+// so the loop only queues each control's values and commits the channel frames the worker hands back. Both
+// directions are lock-free single producer / single consumer queues: the loop produces commands and consumes
+// frames, the worker the opposite. Frames are committed from loop() as output drivers are not thread safe.
+class RenderWorker : public Component {
+ public:
+  static const size_t COMMAND_CAPACITY = 16;
+  static const size_t FRAME_CAPACITY = 16;
+  // Each output pushes one frame per render, and the loop only takes whole renders, so a light's render has to fit
+  // in the frame queue (which holds FRAME_CAPACITY - 1) or the worker waits for room forever
+  static const size_t MAX_OUTPUTS_PER_LIGHT = FRAME_CAPACITY - 2;
+  static const uint32_t STATS_INTERVAL_MS = 60000;
+
+  static RenderWorker *instance() {
+    static RenderWorker worker;
+    return &worker;
+  }
+
+  // Routes a light's output frames through the worker, before any of its commands are posted. Returns false, leaving
+  // the outputs as they were, if the light has more than MAX_OUTPUTS_PER_LIGHT outputs.
+  bool attach(XyLightOutput *light, const std::vector<XyOutput *> &outputs);
+
+  // Loop side, queues the light's new values and wakes the worker
+  void post(XyLightOutput *light, const XyLightCommand &command);
+
+  const RenderWorkerStats &stats() const { return this->_stats; }
+  size_t depth() const { return this->_commands.size(); }
+  // Loop side. Every posted command has been rendered and its frames committed, ie to step a simulation.
+  bool settled() const;
+
+  void setup() override;
+  void loop() override;
+  void dump_config() override;
+
+  float get_setup_priority() const override { return setup_priority::DATA; }
+
+  // Takes and renders every queued command, then returns. Run by the worker task, or directly when testing.
+  void drain();
+
+  // Stops and joins the worker thread (host only, ie at the end of a test)
+  void stop();
+
+ protected:
+  struct QueuedCommand {
+    XyLightOutput *light;
+    XyLightCommand command;
+  };
+
+  struct QueuedFrame {
+    XyFrameSink *sink;
+    XyFrame frame;
+    uint32_t posted_us;
+  };
+
+  // Installed as an output's frame sink, queues its frames for the sink it replaced
+  class DeferredFrameSink : public XyFrameSink {
+   public:
+    DeferredFrameSink(RenderWorker *worker, XyFrameSink *target) : _worker(worker), _target(target) {}
+
+    void commit_frame(const XyFrame &frame) override { this->_worker->push_frame(this->_target, frame); }
+    // The light's render is complete, so its frames can be committed
+    void latch() override {
+      this->_worker->_frames_complete.store(this->_worker->_frames_pushed, std::memory_order_release);
+    }
+
+   protected:
+    RenderWorker *_worker;
+    XyFrameSink *_target;
+  };
+
+  // Worker side only, after attach(). Lights whose idle work (ie rebuilding LUTs) runs on the worker.
+  std::vector<XyLightOutput *> _lights;
+
+  SpscQueue<QueuedCommand, COMMAND_CAPACITY> _commands;
+  SpscQueue<QueuedFrame, FRAME_CAPACITY> _frames;
+  std::vector<std::unique_ptr<DeferredFrameSink>> _sinks;
+
+  // Loop side only. The newest unqueued command of each light, retried from loop().
+  std::vector<QueuedCommand> _unposted;
+
+  // Worker side only. Post time of the newest command in the frames being rendered.
+  uint32_t _rendering_posted_us = 0;
+
+  // Frames pushed by the worker, and of those the ones belonging to a complete render. The loop only takes whole
+  // renders, so it never commits some of a light's outputs without the others.
+  uint32_t _frames_pushed = 0;
+  std::atomic<uint32_t> _frames_complete{0};
+  // Loop side only
+  uint32_t _frames_taken = 0;
+
+  // Loop side, apart from renders which is counted by the worker (and only read by tests once it has stopped)
+  RenderWorkerStats _stats;
+  uint32_t _last_stats_ms = 0;
+  uint32_t _reported_frames = 0;
+
+  std::atomic<bool> _running{false};
+  // Set by drain() before it takes any commands, so an empty command queue with this clear means none are in flight
+  std::atomic<bool> _draining{false};
+
+  void push_frame(XyFrameSink *sink, const XyFrame &frame);
+  // Worker side
+  void render(XyLightOutput *light, uint32_t posted_us);
+  // Loop side, commits the complete renders and latches their sinks
+  void commit_frames();
+  // Worker side, while no commands are queued
+  void idle();
+  void wake();
+  void wait();
+  static void run(void *param);
+
+#ifdef USE_HOST
+  std::thread _thread;
+  std::mutex _wake_mutex;
+  std::condition_variable _wake;
+  bool _woken = false;
+#elif defined(USE_ESP32)
+  TaskHandle_t _task = nullptr;
+#endif
+};
+
+}  // namespace xy_light
+}  // namespace esphome
@@ -2,6 +2,8 @@
 #include "esphome/core/log.h"
 #include "esphome/core/component.h"
 #include "esphome/components/output/float_output.h"
+#include "esphome/components/xy_light/calibration_telemetry.h"
+#include "esphome/components/xy_light/xy_output.h"
 #include "esphome/components/xy_light/color_spaces.h"
 #include "esphome/components/xy_light/rgb_profile.h"
 #include "esphome/components/xy_light/cwww_profile.h"
@@ -14,12 +16,12 @@ class RgbCwWwXyOutput : public Component, public XyOutput {
 
   bool _calibration_logging = false;
 
-  output::FloatOutput *_r = NULL;
-  output::FloatOutput *_g = NULL;
-  output::FloatOutput *_b = NULL;
+  XyChannel _r{"red"};
+  XyChannel _g{"green"};
+  XyChannel _b{"blue"};
 
-  output::FloatOutput *_cw = NULL;
-  output::FloatOutput *_ww = NULL;
+  XyChannel _cw{"cold_white"};
+  XyChannel _ww{"warm_white"};
 
  public:
   RgbChromaTransform rgb_profile_transform;
@@ -27,48 +29,83 @@ class RgbCwWwXyOutput : public Component, public XyOutput {
   
   void set_color_XYZ(float X, float Y, float Z) override {
     auto XYZ = color_space::XYZ_Cie1931(X, Y, Z);
-    auto rgb = this->rgb_profile_transform.XYZ_to_RGB(XYZ);
-    auto cwww = this->cwww_profile_transform.XYZ_to_CwWw(XYZ);
+    this->write_rgb_cwww(this->rgb_profile_transform.XYZ_to_RGB(XYZ), this->cwww_profile_transform.XYZ_to_CwWw(XYZ));
+  }
 
-    if (this->_calibration_logging)
-      this->log_calibration_data(rgb, cwww);
+  void set_color_CT(const XyCtFrame &ct, float r, float g, float b) override {
+    auto XYZ = this->_source_transform * matrices::Vec3(r, g, b);
+    this->set_color_CT_XYZ(ct, XYZ.x, XYZ.y, XYZ.z);
+  }
 
-    cwww = cwww.clamp_truncate();
-    rgb = rgb.clamp_truncate();
-    if (this->_r)
-      this->_r->set_level(rgb.r);
+  void set_color_CT_XYZ(const XyCtFrame &ct, float X, float Y, float Z) override {
+    this->write_rgb_cwww(this->rgb_profile_transform.XYZ_to_RGB(color_space::XYZ_Cie1931(X, Y, Z)),
+                         this->cwww_profile_transform.CT_to_CwWw(ct.mired, ct.Y));
+  }
 
-    if (this->_g)
-      this->_g->set_level(rgb.g);
+  void set_color_XYZ_fixed(const fixed_point::Vec3 &XYZ) override {
+    auto rgb = this->rgb_profile_transform.XYZ_to_RGB_fixed(XYZ);
+    auto cwww = this->cwww_profile_transform.XYZ_to_CwWw_fixed(XYZ);
 
-    if (this->_b)
-      this->_b->set_level(rgb.b);
+    if (this->_calibration_logging)
+      this->log_calibration_data(color_space::RGB::from_fixed(rgb), color_space::CwWw::from_fixed(cwww));
+
+    this->write_level(this->_r, rgb.x);
+    this->write_level(this->_g, rgb.y);
+    this->write_level(this->_b, rgb.z);
+    this->write_level(this->_cw, cwww.x);
+    this->write_level(this->_ww, cwww.y);
+    this->commit_frame();
+  }
 
-    if (this->_cw)
-      this->_cw->set_level(cwww.cw);
+  void enable_calibration_logging(bool enable) { this->_calibration_logging = enable; }
 
-    if (this->_ww)
-      this->_ww->set_level(cwww.ww);
+  std::vector<XyChannel *> channels() override {
+    return {&this->_r, &this->_g, &this->_b, &this->_cw, &this->_ww};
   }
 
-  void enable_calibration_logging(bool enable) { this->_calibration_logging = enable; }
+  optional<color_space::XYZ_Cie1931> levels_to_XYZ(const float *levels) override {
+    auto rgb = this->rgb_profile_transform.RGB_to_XYZ(color_space::RGB(levels[0], levels[1], levels[2]));
+    auto cwww = this->cwww_profile_transform.CwWw_to_XYZ(color_space::CwWw(levels[3], levels[4]));
+    return color_space::XYZ_Cie1931(rgb.X + cwww.X, rgb.Y + cwww.Y, rgb.Z + cwww.Z);
+  }
 
   void set_color_profile(RgbProfile *profile) { this->rgb_profile_transform = profile->get_chroma_transform(); }
 
   void set_cwww_profile(CwWwProfile *profile) { this->cwww_profile_transform = profile->get_chroma_transform(); }
 
-  void set_red_output(output::FloatOutput *red) { this->_r = red; }
+  void set_red_output(output::FloatOutput *red) { this->_r.output = red; }
 
-  void set_green_output(output::FloatOutput *green) { this->_g = green; }
+  void set_green_output(output::FloatOutput *green) { this->_g.output = green; }
 
-  void set_blue_output(output::FloatOutput *blue) { this->_b = blue; }
+  void set_blue_output(output::FloatOutput *blue) { this->_b.output = blue; }
 
-  void set_cold_white_output(output::FloatOutput *cw) { this->_cw = cw; }
+  void set_cold_white_output(output::FloatOutput *cw) { this->_cw.output = cw; }
 
-  void set_warm_white_output(output::FloatOutput *ww) { this->_ww = ww; }
+  void set_warm_white_output(output::FloatOutput *ww) { this->_ww.output = ww; }
 
  private:
+  void write_rgb_cwww(color_space::RGB rgb, color_space::CwWw cwww) {
+    if (this->_calibration_logging && !this->capturing())
+      this->log_calibration_data(rgb, cwww);
+
+    cwww = cwww.clamp_truncate();
+    rgb = rgb.clamp_truncate();
+    this->write_level(this->_r, rgb.r);
+    this->write_level(this->_g, rgb.g);
+    this->write_level(this->_b, rgb.b);
+    this->write_level(this->_cw, cwww.cw);
+    this->write_level(this->_ww, cwww.ww);
+    this->commit_frame();
+  }
+
   static void log_calibration_data(color_space::RGB rgb, color_space::CwWw cwww) {
+    CalibrationTelemetry::instance()->push(&RgbCwWwXyOutput::format_calibration_data,
+                                           {rgb.r, rgb.g, rgb.b, cwww.cw, cwww.ww});
+  }
+
+  static void format_calibration_data(const float *values) {
+    auto rgb = color_space::RGB(values[0], values[1], values[2]);
+    auto cwww = color_space::CwWw(values[3], values[4]);
     auto rgb_max = rgb.max();
     auto cwww_max = cwww.max();
 
@@ -8,7 +8,9 @@ from .xy_output import (xy_light_ns, XyOutput)
 from .rgb_profile import (RGB_PROFILE_CONFIG_SCHEMA, RgbProfile, to_rgb_profile_code)
 from .cwww_profile import (CWWW_PROFILE_CONFIG_SCHEMA, CwWwProfile, to_cwww_profile_code)
 
-from .xy_output import CONF_XY_OUTPUT_CALIBRATION_LOGGING
+from .xy_output import (CONF_XY_OUTPUT_CALIBRATION_LOGGING, to_calibration_logging_code)
+from .xy_output import CONF_XY_OUTPUT_BIT_DEPTH
+from .xy_output import (CONF_XY_OUTPUT_FRAME_SINK_ID, XyFrameSink)
 from .xy_output import (CONF_XY_OUTPUT_RGB_COLOR_PROFILE_ID, CONF_XY_OUTPUT_RGB_COLOR_PROFILE)
 from .xy_output import (CONF_XY_OUTPUT_RED_OUTPUT_ID, CONF_XY_OUTPUT_GREEN_OUTPUT_ID, CONF_XY_OUTPUT_BLUE_OUTPUT_ID)
 
@@ -24,6 +26,12 @@ RGB_CWWW_XY_OUTPUT_CONFIG_SCHEMA = cv.All(
 
         # Calibration Logging 
         cv.Optional(CONF_XY_OUTPUT_CALIBRATION_LOGGING): cv.boolean,
+
+        # Resolution of the outputs, writes which round to the same duty are skipped
+        cv.Optional(CONF_XY_OUTPUT_BIT_DEPTH): cv.int_range(min=1, max=16),
+
+        # Commits all channels of a frame at once, rather than one set_level() per channel
+        cv.Optional(CONF_XY_OUTPUT_FRAME_SINK_ID): cv.use_id(XyFrameSink),
          
         cv.Optional(CONF_XY_OUTPUT_RED_OUTPUT_ID): cv.use_id(output.FloatOutput),
         cv.Optional(CONF_XY_OUTPUT_GREEN_OUTPUT_ID): cv.use_id(output.FloatOutput),
@@ -49,7 +57,7 @@ async def to_rgb_cwww_xy_output_code(config):
     if CONF_XY_OUTPUT_CALIBRATION_LOGGING in config:     
         enable_cal_log = config[CONF_XY_OUTPUT_CALIBRATION_LOGGING]
         if enable_cal_log:
-            cg.add(var.enable_calibration_logging(True))    
+            await to_calibration_logging_code(var)
 
     # Color Profile - RGB
     if CONF_XY_OUTPUT_RGB_COLOR_PROFILE_ID in config:     
@@ -95,4 +103,11 @@ async def to_rgb_cwww_xy_output_code(config):
         warm_white_output = await cg.get_variable(config[CONF_XY_OUTPUT_WARM_WHITE_OUTPUT_ID])
         cg.add(var.set_warm_white_output(warm_white_output))
 
+    if CONF_XY_OUTPUT_BIT_DEPTH in config:
+        cg.add(var.set_bit_depth(config[CONF_XY_OUTPUT_BIT_DEPTH]))
+
+    if CONF_XY_OUTPUT_FRAME_SINK_ID in config:
+        sink = await cg.get_variable(config[CONF_XY_OUTPUT_FRAME_SINK_ID])
+        cg.add(var.set_frame_sink(sink))
+
     await cg.register_component(var, config)
@@ -3,7 +3,9 @@
 #include "esphome/core/component.h"
 
 #include "esphome/components/xy_light/color_spaces.h"
+#include "esphome/components/xy_light/fixed_point.h"
 #include "esphome/components/xy_light/matrices.h"
+#include "esphome/components/xy_light/profiling.h"
 
 namespace esphome {
 namespace xy_light {
@@ -19,41 +21,16 @@ class RgbChromaTransform {
   float _gamma;
 
   color_space::RGBIntensityCalibration _int_cal;
+  optional<color_space::RGBIntensityCalibrationFixed> _int_cal_fixed;
 
   optional<matrices::Vec3> _wp_scale, _wp_scale_inv;
   optional<matrices::Matrix3x3> _XYZ2RGB_d, _XYZ2RGB_inv_d;
   optional<matrices::Matrix3x3> _XYZ2RGB, _RGB2XYZ;
+  optional<fixed_point::Matrix3x3> _XYZ2RGB_fixed, _RGB2XYZ_fixed;
+  optional<fixed_point::Vec2> _w_xy_fixed;
 
-  color_space::RGB (*_gamma_decompress_fn)(color_space::RGB, float);
-  color_space::RGB (*_gamma_compress_fn)(color_space::RGB, float);
-
-  static color_space::RGB exp_decompress_gamma(color_space::RGB rgb, float g) {
-    float (*fn)(float, float) = color_space::exp_gamma_decompress;
-    return color_space::RGB(fn(rgb.r, g), fn(rgb.g, g), fn(rgb.b, g));
-  }
-
-  static color_space::RGB exp_compress_gamma(color_space::RGB rgb, float g) {
-    float (*fn)(float, float) = color_space::exp_gamma_compress;
-    return color_space::RGB(fn(rgb.r, g), fn(rgb.g, g), fn(rgb.b, g));
-  }
-
-  static color_space::RGB srgb_decompress_gamma(color_space::RGB rgb, float g) {
-    float (*fn)(float, float) = color_space::srgb_gamma_decompress;
-    return color_space::RGB(fn(rgb.r, g), fn(rgb.g, g), fn(rgb.b, g));
-  }
-
-  static color_space::RGB srgb_compress_gamma(color_space::RGB rgb, float g) {
-    float (*fn)(float, float) = color_space::srgb_gamma_compress;
-    return color_space::RGB(fn(rgb.r, g), fn(rgb.g, g), fn(rgb.b, g));
-  }
-
-  static color_space::RGB no_decompress_gamma(color_space::RGB rgb, float g) {
-    return rgb;
-  }
-
-  static color_space::RGB no_compress_gamma(color_space::RGB rgb, float g) {
-    return rgb;
-  }
+  color_space::TransferFunction _gamma_decompress;
+  color_space::TransferFunction _gamma_compress;
 
  public:
   RgbChromaTransform()
@@ -63,8 +40,8 @@ class RgbChromaTransform {
         _w(color_space::Xy_Cie1931()),
         _gamma(1.0f) {
     this->_w = color_space::Cie2dColorSpace::Illuminant_d65();
-    this->_gamma_decompress_fn = RgbChromaTransform::no_decompress_gamma;
-    this->_gamma_compress_fn = RgbChromaTransform::no_compress_gamma;
+    this->_gamma_decompress = color_space::TransferFunction();
+    this->_gamma_compress = color_space::TransferFunction();
   }
 
   void set_typical_led() {
@@ -73,8 +50,8 @@ class RgbChromaTransform {
     this->_b = color_space::Xy_Cie1931(0.15f, 0.06f);
     this->_w = color_space::Cie2dColorSpace::Illuminant_d65();
     this->_gamma = 1.0f;
-    this->_gamma_decompress_fn = RgbChromaTransform::no_decompress_gamma;
-    this->_gamma_compress_fn = RgbChromaTransform::no_compress_gamma;
+    this->_gamma_decompress = color_space::TransferFunction();
+    this->_gamma_compress = color_space::TransferFunction();
   }
 
   void set_sRGB() {
@@ -83,8 +60,8 @@ class RgbChromaTransform {
     this->_b = color_space::Xy_Cie1931(0.1500f, 0.0600f);
     this->_w = color_space::Cie2dColorSpace::Illuminant_d65();
     this->_gamma = 2.4f;
-    this->_gamma_decompress_fn = RgbChromaTransform::srgb_decompress_gamma;
-    this->_gamma_compress_fn = RgbChromaTransform::srgb_compress_gamma;
+    this->_gamma_decompress = color_space::TransferFunction::srgb_gamma_decompress(this->_gamma);
+    this->_gamma_compress = color_space::TransferFunction::srgb_gamma_compress(this->_gamma);
   }
 
   void set_AdobeRGB_D55() {
@@ -93,8 +70,8 @@ class RgbChromaTransform {
     this->_b = color_space::Xy_Cie1931(0.1500f, 0.0600f);
     this->_w = color_space::Cie2dColorSpace::Illuminant_d55();
     this->_gamma = 2.2f;
-    this->_gamma_decompress_fn = RgbChromaTransform::exp_decompress_gamma;
-    this->_gamma_compress_fn = RgbChromaTransform::exp_compress_gamma;
+    this->_gamma_decompress = color_space::TransferFunction::exp_gamma_decompress(this->_gamma);
+    this->_gamma_compress = color_space::TransferFunction::exp_gamma_compress(this->_gamma);
   }
 
   void set_AdobeRGB_D65() {
@@ -103,8 +80,8 @@ class RgbChromaTransform {
     this->_b = color_space::Xy_Cie1931(0.1500f, 0.0600f);
     this->_w = color_space::Cie2dColorSpace::Illuminant_d65();
     this->_gamma = 2.2f;
-    this->_gamma_decompress_fn = RgbChromaTransform::exp_decompress_gamma;
-    this->_gamma_compress_fn = RgbChromaTransform::exp_compress_gamma;
+    this->_gamma_decompress = color_space::TransferFunction::exp_gamma_decompress(this->_gamma);
+    this->_gamma_compress = color_space::TransferFunction::exp_gamma_compress(this->_gamma);
   }
 
   void set_ProPhoto() {
@@ -113,8 +90,8 @@ class RgbChromaTransform {
     this->_b = color_space::Xy_Cie1931(0.0366f, 0.0001f);
     this->_w = color_space::Cie2dColorSpace::Illuminant_d50();
     this->_gamma = 1.8f;
-    this->_gamma_decompress_fn = RgbChromaTransform::exp_decompress_gamma;
-    this->_gamma_compress_fn = RgbChromaTransform::exp_compress_gamma;
+    this->_gamma_decompress = color_space::TransferFunction::exp_gamma_decompress(this->_gamma);
+    this->_gamma_compress = color_space::TransferFunction::exp_gamma_compress(this->_gamma);
   }
 
   void set_ACES_AP0() {
@@ -123,8 +100,8 @@ class RgbChromaTransform {
     this->_b = color_space::Xy_Cie1931(0.0001f, -0.0770f);  // Not a typo
     this->_w = color_space::Xy_Cie1931(0.32168f, 0.33767f);
     this->_gamma = 1.0f;
-    this->_gamma_decompress_fn = RgbChromaTransform::no_decompress_gamma;
-    this->_gamma_compress_fn = RgbChromaTransform::no_compress_gamma;
+    this->_gamma_decompress = color_space::TransferFunction();
+    this->_gamma_compress = color_space::TransferFunction();
   }
 
   void set_ACES_AP1() {
@@ -133,15 +110,15 @@ class RgbChromaTransform {
     this->_b = color_space::Xy_Cie1931(0.128f, 0.044f);
     this->_w = color_space::Xy_Cie1931(0.32168f, 0.33767f);
     this->_gamma = 1.0f;
-    this->_gamma_decompress_fn = RgbChromaTransform::no_decompress_gamma;
-    this->_gamma_compress_fn = RgbChromaTransform::no_compress_gamma;
+    this->_gamma_decompress = color_space::TransferFunction();
+    this->_gamma_compress = color_space::TransferFunction();
   }
   float gamma() { return this->_gamma; }
 
   void set_gamma(float g) { 
     this->_gamma = g;
-    this->_gamma_decompress_fn = RgbChromaTransform::exp_decompress_gamma;
-    this->_gamma_compress_fn = RgbChromaTransform::exp_compress_gamma;
+    this->_gamma_decompress = color_space::TransferFunction::exp_gamma_decompress(this->_gamma);
+    this->_gamma_compress = color_space::TransferFunction::exp_gamma_compress(this->_gamma);
   }
 
   void set_illuminant_a() {
@@ -190,43 +167,43 @@ class RgbChromaTransform {
 
 
   // Weighted calibration 
-  void set_weighted_red_intensity(float i) { this->_int_cal.r_int_output_cal = i; }
+  void set_weighted_red_intensity(float i) { this->_int_cal.r_int_output_cal = i; this->_int_cal_fixed.reset(); }
   float weighted_red_intensity() { return this->_int_cal.r_int_output_cal; }
 
-  void set_weighted_green_intensity(float i) { this->_int_cal.g_int_output_cal = i; }
+  void set_weighted_green_intensity(float i) { this->_int_cal.g_int_output_cal = i; this->_int_cal_fixed.reset(); }
   float weighted_green_intensity() { return this->_int_cal.g_int_output_cal;}
 
-  void set_weighted_blue_intensity(float i) { this->_int_cal.b_int_output_cal = i; }
+  void set_weighted_blue_intensity(float i) { this->_int_cal.b_int_output_cal = i; this->_int_cal_fixed.reset(); }
   float weighted_blue_intensity() { return this->_int_cal.b_int_output_cal;}
 
   // Max calibration 
-  void set_max_red_intensity(float i) { this->_int_cal.r_max_output_cal = i;}
+  void set_max_red_intensity(float i) { this->_int_cal.r_max_output_cal = i; this->_int_cal_fixed.reset(); }
   float max_red_intensity() { return this->_int_cal.r_max_output_cal;}
 
-  void set_max_green_intensity(float i) { this->_int_cal.g_max_output_cal = i;}
+  void set_max_green_intensity(float i) { this->_int_cal.g_max_output_cal = i; this->_int_cal_fixed.reset(); }
   float max_green_intensity() { return this->_int_cal.g_max_output_cal;}
 
-  void set_max_blue_intensity(float i) { this->_int_cal.b_max_output_cal = i;}
+  void set_max_blue_intensity(float i) { this->_int_cal.b_max_output_cal = i; this->_int_cal_fixed.reset(); }
   float max_blue_intensity() { return this->_int_cal.b_max_output_cal;}
 
   // Min calibration 
-  void set_min_red_intensity(float i) { this->_int_cal.r_min_output_cal = i;}
+  void set_min_red_intensity(float i) { this->_int_cal.r_min_output_cal = i; this->_int_cal_fixed.reset(); }
   float min_red_intensity() { return this->_int_cal.r_min_output_cal;}
 
-  void set_min_green_intensity(float i) { this->_int_cal.g_min_output_cal = i;}
+  void set_min_green_intensity(float i) { this->_int_cal.g_min_output_cal = i; this->_int_cal_fixed.reset(); }
   float min_green_intensity() { return this->_int_cal.g_min_output_cal;}
 
-  void set_min_blue_intensity(float i) { this->_int_cal.b_min_output_cal = i;}
+  void set_min_blue_intensity(float i) { this->_int_cal.b_min_output_cal = i; this->_int_cal_fixed.reset(); }
   float min_blue_intensity() { return this->_int_cal.b_min_output_cal;}
 
   // Color gamma calibration
-  void set_red_gamma(float g) { this->_int_cal.r_gamma = g;}
+  void set_red_gamma(float g) { this->_int_cal.set_r_gamma(g); this->_int_cal_fixed.reset(); }
   float red_gamma() { return this->_int_cal.r_gamma;}
   
-  void set_green_gamma(float g) { this->_int_cal.g_gamma = g;}
+  void set_green_gamma(float g) { this->_int_cal.set_g_gamma(g); this->_int_cal_fixed.reset(); }
   float green_gamma() { return this->_int_cal.g_gamma;}
 
-  void set_blue_gamma(float g) { this->_int_cal.b_gamma = g;}
+  void set_blue_gamma(float g) { this->_int_cal.set_b_gamma(g); this->_int_cal_fixed.reset(); }
   float blue_gamma() { return this->_int_cal.b_gamma;}
 
   color_space::xyY_Cie1931 adjust_saturation(color_space::xyY_Cie1931 xyY, float sat) {
@@ -242,7 +219,17 @@ class RgbChromaTransform {
   }
 
   color_space::XYZ_Cie1931 adjust_white_balance(color_space::XYZ_Cie1931 xyz, color_space::Cie2dColorSpace target_white_point) {
+    auto scale = this->white_balance_scale(target_white_point);
+
+    xyz.X = xyz.X * scale.x;
+    xyz.Y = xyz.Y * scale.y;
+    xyz.Z = xyz.Z * scale.z;
+
+    return xyz;
+  }
 
+  // Per component XYZ scale which moves this transform's white point to the target white point
+  matrices::Vec3 white_balance_scale(color_space::Cie2dColorSpace target_white_point) {
     auto source_white_point_XYZ = this->_w.as_xy_cie1931().as_XYZ_cie1931(1.0f);
     auto target_white_point_XYZ = target_white_point.as_xy_cie1931().as_XYZ_cie1931(1.0f);
 
@@ -253,16 +240,24 @@ class RgbChromaTransform {
     double scale_Y = (target_white_point_XYZ.Y / target_sum) / (source_white_point_XYZ.Y / source_sum);
     double scale_Z = (target_white_point_XYZ.Z / target_sum) / (source_white_point_XYZ.Z / source_sum);
 
-    xyz.X = xyz.X * scale_X;
-    xyz.Y = xyz.Y * scale_Y;
-    xyz.Z = xyz.Z * scale_Z;
-
-    return xyz;
+    return matrices::Vec3(scale_X, scale_Y, scale_Z);
   }
 
+  // Fixed point counterpart of adjust_saturation(), with xyY packed into x, y and z
+  fixed_point::Vec3 adjust_saturation(const fixed_point::Vec3 &xyY, fixed_point::fixed_t sat) {
+    if (!this->_w_xy_fixed.has_value()) {
+      auto w_xy = _w.as_xy_cie1931();
+      this->_w_xy_fixed = fixed_point::Vec2(fixed_point::from_float(w_xy.x), fixed_point::from_float(w_xy.y));
+    }
+    auto &w_xy = this->_w_xy_fixed.value();
+    auto desat = fixed_point::ONE - sat;
+
+    return fixed_point::Vec3(xyY.x + fixed_point::mul(desat, w_xy.x - xyY.x),
+                             xyY.y + fixed_point::mul(desat, w_xy.y - xyY.y), fixed_point::mul(sat, xyY.z) + desat);
+  }
 
   color_space::XYZ_Cie1931 RGB_to_XYZ(color_space::RGB rgb) {
-    auto rgb_decomp =  this->_gamma_decompress_fn(rgb, this->_gamma);
+    auto rgb_decomp = this->RGB_to_linear_RGB(rgb);
     
     auto XYZ = RGB_2_Cie1931XYZ_transform_matrix() * matrices::Vec3(rgb_decomp.r, rgb_decomp.g, rgb_decomp.b);
     return color_space::XYZ_Cie1931(XYZ.x, XYZ.y, XYZ.z);
@@ -270,12 +265,54 @@ class RgbChromaTransform {
 
   color_space::RGB XYZ_to_RGB(color_space::XYZ_Cie1931 XYZ) {
     auto rgb_xyz = Cie1931XYZ_2_rgb_transform_matrix() * matrices::Vec3(XYZ.X, XYZ.Y, XYZ.Z);
+    return this->linear_RGB_to_RGB(color_space::RGB(rgb_xyz.x, rgb_xyz.y, rgb_xyz.z));
+  }
+
+  color_space::RGB RGB_to_linear_RGB(color_space::RGB rgb) { return rgb.apply(this->_gamma_decompress); }
+
+  // Gamma compressed and calibrated, but not yet clamped
+  color_space::RGB linear_RGB_to_RGB(color_space::RGB rgb) {
+    XY_PROFILE_STAGE(PROFILE_CALIBRATION);
+    auto rgb_comp = rgb.apply(this->_gamma_compress);
+    return this->_int_cal.apply_calibration(rgb_comp);
+  }
+
+  // Linear RGB to XYZ, with the white balance scale for the target white point folded in
+  matrices::Matrix3x3 white_balanced_RGB_2_Cie1931XYZ_transform_matrix(
+      color_space::Cie2dColorSpace target_white_point) {
+    auto wb = this->white_balance_scale(target_white_point);
+    auto &m = this->RGB_2_Cie1931XYZ_transform_matrix();
+    return matrices::Matrix3x3(m(0, 0) * wb.x, m(0, 1) * wb.x, m(0, 2) * wb.x,  //
+                               m(1, 0) * wb.y, m(1, 1) * wb.y, m(1, 2) * wb.y,  //
+                               m(2, 0) * wb.z, m(2, 1) * wb.z, m(2, 2) * wb.z);
+  }
+
+  // Fixed point pipeline. Gamma curves are still evaluated from their float tables, all else is integer math.
+  fixed_point::Vec3 RGB_to_XYZ_fixed(color_space::RGB rgb) {
+    auto rgb_decomp = rgb.apply(this->_gamma_decompress);
+    return this->RGB_2_Cie1931XYZ_transform_matrix_fixed() *
+           fixed_point::Vec3::from_float(rgb_decomp.r, rgb_decomp.g, rgb_decomp.b);
+  }
 
-    auto rgb = color_space::RGB(rgb_xyz.x, rgb_xyz.y, rgb_xyz.z);
-    auto rgb_comp = this->_gamma_compress_fn(rgb, this->_gamma);
-    auto rgb_cal = this->_int_cal.apply_calibration(rgb_comp);
+  // Calibrated RGB values, not yet clamped
+  fixed_point::Vec3 XYZ_to_RGB_fixed(const fixed_point::Vec3 &XYZ) {
+    auto rgb = this->Cie1931XYZ_2_rgb_transform_matrix_fixed() * XYZ;
+    XY_PROFILE_STAGE(PROFILE_CALIBRATION);
+    rgb = fixed_point::Vec3(this->_gamma_compress.eval_fixed(rgb.x), this->_gamma_compress.eval_fixed(rgb.y),
+                            this->_gamma_compress.eval_fixed(rgb.z));
+
+    if (!this->_int_cal_fixed.has_value()) {
+      this->_int_cal_fixed = color_space::RGBIntensityCalibrationFixed(this->_int_cal);
+    }
+    return this->_int_cal_fixed.value().apply_calibration(rgb);
+  }
 
-    return rgb_cal;
+  // Precomputed matrices for the current primaries and white point (ie baked at build time),
+  // which saves inverting them on the device. Any later change to the chromaticities discards them.
+  void set_transform_matrices(const matrices::Matrix3x3 &RGB2XYZ, const matrices::Matrix3x3 &XYZ2RGB) {
+    this->reset_transform_matrix();
+    this->_RGB2XYZ = RGB2XYZ;
+    this->_XYZ2RGB = XYZ2RGB;
   }
 
   matrices::Matrix3x3 &RGB_2_Cie1931XYZ_transform_matrix() {
@@ -303,6 +340,20 @@ class RgbChromaTransform {
     return this->_XYZ2RGB.value();
   }
 
+  fixed_point::Matrix3x3 &RGB_2_Cie1931XYZ_transform_matrix_fixed() {
+    if (!this->_RGB2XYZ_fixed.has_value()) {
+      this->_RGB2XYZ_fixed = fixed_point::Matrix3x3::from_float(this->RGB_2_Cie1931XYZ_transform_matrix());
+    }
+    return this->_RGB2XYZ_fixed.value();
+  }
+
+  fixed_point::Matrix3x3 &Cie1931XYZ_2_rgb_transform_matrix_fixed() {
+    if (!this->_XYZ2RGB_fixed.has_value()) {
+      this->_XYZ2RGB_fixed = fixed_point::Matrix3x3::from_float(this->Cie1931XYZ_2_rgb_transform_matrix());
+    }
+    return this->_XYZ2RGB_fixed.value();
+  }
+
  protected:
  
   void reset_chroma() {
@@ -314,11 +365,14 @@ class RgbChromaTransform {
   void reset_transform_matrix() {
     this->_XYZ2RGB.reset();
     this->_RGB2XYZ.reset();
+    this->_XYZ2RGB_fixed.reset();
+    this->_RGB2XYZ_fixed.reset();
   }
 
   void reset_scale_vec() {
     this->_wp_scale.reset();
     this->_wp_scale_inv.reset();
+    this->_w_xy_fixed.reset();
     this->reset_transform_matrix();
   }
 
@@ -444,6 +498,11 @@ class RgbProfile : public Component {
 
   void set_blue_gamma(float g) { this->_chroma_transform.set_blue_gamma(g); }
 
+  // Build time transform matrices, must be set after the chromaticities
+  void set_transform_matrices(const matrices::Matrix3x3 &RGB2XYZ, const matrices::Matrix3x3 &XYZ2RGB) {
+    this->_chroma_transform.set_transform_matrices(RGB2XYZ, XYZ2RGB);
+  }
+
   RgbChromaTransform get_chroma_transform() { return this->_chroma_transform; }
 };
 
@@ -26,6 +26,7 @@ from .profile import CONF_PROFILE_GAMMA
 
 # RGB Profile Common 
 RgbProfile = xy_light_ns.class_("RgbProfile", cg.Component)
+Matrix3x3 = xy_light_ns.namespace("matrices").class_("Matrix3x3")
 
 RGB_PROFILE_CONFIG_SCHEMA = cv.All(
     cv.Schema({ 
@@ -78,9 +79,39 @@ RGB_PROFILE_CONFIG_SCHEMA = cv.All(
     cv.has_exactly_one_key(CONF_PROFILE_BLUE_XY, CONF_PROFILE_BLUE_WAVELENGTH, CONF_PROFILE_STANDARD_PROFILE)
 )
 
+# Chromaticities of the standard profiles, these must match the presets in RgbChromaTransform
+STANDARD_PROFILE_CHROMATICITIES = {
+    CONF_PROFILE_STANDARD_PROFILE__LED: ([0.7, 0.3], [0.3, 0.6], [0.15, 0.06], cie.ILLUMINANT_D65),
+    CONF_PROFILE_STANDARD_PROFILE__SRGB: ([0.64, 0.33], [0.30, 0.60], [0.15, 0.06], cie.ILLUMINANT_D65),
+    CONF_PROFILE_STANDARD_PROFILE__AdobeRGB_D55: ([0.64, 0.33], [0.21, 0.71], [0.15, 0.06], cie.ILLUMINANT_D55),
+    CONF_PROFILE_STANDARD_PROFILE__AdobeRGB_D65: ([0.64, 0.33], [0.21, 0.71], [0.15, 0.06], cie.ILLUMINANT_D65),
+    CONF_PROFILE_STANDARD_PROFILE__ACES_AP0: ([0.7347, 0.2653], [0.0, 1.0], [0.0001, -0.077], [0.32168, 0.33767]),
+    CONF_PROFILE_STANDARD_PROFILE__ACES_AP1: ([0.713, 0.293], [0.165, 0.830], [0.128, 0.044], [0.32168, 0.33767])
+}
+
+def to_matrix_expression(m):
+    return Matrix3x3(*[float(v) for row in m for v in row])
+
+def to_transform_matrices_expressions(r_xy, g_xy, b_xy, w_xy):
+    (RGB2XYZ, XYZ2RGB) = cie.rgb_transform_matrices(r_xy, g_xy, b_xy, w_xy)
+    return (to_matrix_expression(RGB2XYZ), to_matrix_expression(XYZ2RGB))
+
+def primary_xy(config, conf_xy, conf_wavelength, default):
+    if conf_xy in config:
+        return config[conf_xy]
+
+    if conf_wavelength in config:
+        # at build time, convert wavelength into x,y
+        return cie.wavelength_to_xy(config[conf_wavelength])
+
+    return default
+
 async def to_rgb_profile_code(config):
     var = cg.new_Pvariable(config[CONF_ID])
    
+    r_xy = g_xy = b_xy = None
+    w_xy = cie.ILLUMINANT_D65
+
     if CONF_PROFILE_STANDARD_PROFILE in config:
         profile_standard = config[CONF_PROFILE_STANDARD_PROFILE]
         if CONF_PROFILE_STANDARD_PROFILE__LED == profile_standard:
@@ -89,27 +120,26 @@ async def to_rgb_profile_code(config):
             cg.add(var.use_sRGB())
         elif CONF_PROFILE_STANDARD_PROFILE__AdobeRGB_D55 == profile_standard:
             cg.add(var.set_AdobeRGB_D55())
-        elif CONF_PROFILE_STANDARD_PROFILE__AdobeRGB_D55 == profile_standard:
+        elif CONF_PROFILE_STANDARD_PROFILE__AdobeRGB_D65 == profile_standard:
             cg.add(var.use_AdobeRGB_D65())
         elif CONF_PROFILE_STANDARD_PROFILE__ACES_AP0 == profile_standard:
             cg.add(var.use_ACES_AP0())
         elif CONF_PROFILE_STANDARD_PROFILE__ACES_AP1 == profile_standard:
             cg.add(var.use_ACES_AP1())
 
+        (r_xy, g_xy, b_xy, w_xy) = STANDARD_PROFILE_CHROMATICITIES[profile_standard]
+
+    r_xy = primary_xy(config, CONF_PROFILE_RED_XY, CONF_PROFILE_RED_WAVELENGTH, r_xy)
+    g_xy = primary_xy(config, CONF_PROFILE_GREEN_XY, CONF_PROFILE_GREEN_WAVELENGTH, g_xy)
+    b_xy = primary_xy(config, CONF_PROFILE_BLUE_XY, CONF_PROFILE_BLUE_WAVELENGTH, b_xy)
 
     if CONF_PROFILE_GAMMA in config:
         g = config[CONF_PROFILE_GAMMA]
         cg.add(var.set_gamma(g))
         
     # Red Calibrations
-    if CONF_PROFILE_RED_XY in config:
-        xy = config[CONF_PROFILE_RED_XY]
-        cg.add(var.set_red_xy(xy[0], xy[1]))
-
-    if CONF_PROFILE_RED_WAVELENGTH in config:
-        # at build time, convert wavelength into x,y
-        xy = cie.wavelength_to_xy(config[CONF_PROFILE_RED_WAVELENGTH])
-        cg.add(var.set_red_xy(xy[0], xy[1]))
+    if CONF_PROFILE_RED_XY in config or CONF_PROFILE_RED_WAVELENGTH in config:
+        cg.add(var.set_red_xy(r_xy[0], r_xy[1]))
 
     if CONF_PROFILE_RED_INTENSITY in config:
         i = config[CONF_PROFILE_RED_INTENSITY]
@@ -128,14 +158,8 @@ async def to_rgb_profile_code(config):
         cg.add(var.set_red_gamma(i))
 
     # Green Calibrations
-    if CONF_PROFILE_GREEN_XY in config:
-        xy = config[CONF_PROFILE_GREEN_XY]
-        cg.add(var.set_green_xy(xy[0], xy[1]))
-
-    if CONF_PROFILE_GREEN_WAVELENGTH in config:
-        # at build time, convert wavelength into x,y
-        xy = cie.wavelength_to_xy(config[CONF_PROFILE_GREEN_WAVELENGTH])
-        cg.add(var.set_green_xy(xy[0], xy[1]))
+    if CONF_PROFILE_GREEN_XY in config or CONF_PROFILE_GREEN_WAVELENGTH in config:
+        cg.add(var.set_green_xy(g_xy[0], g_xy[1]))
 
     if CONF_PROFILE_GREEN_INTENSITY in config:
         i = config[CONF_PROFILE_GREEN_INTENSITY]
@@ -154,14 +178,8 @@ async def to_rgb_profile_code(config):
         cg.add(var.set_green_gamma(i))
 
     # Blue Calibrations
-    if CONF_PROFILE_BLUE_XY in config:
-        xy = config[CONF_PROFILE_BLUE_XY]
-        cg.add(var.set_blue_xy(xy[0], xy[1]))
-
-    if CONF_PROFILE_BLUE_WAVELENGTH in config:
-        # at build time, convert wavelength into x,y
-        xy = cie.wavelength_to_xy(config[CONF_PROFILE_BLUE_WAVELENGTH])
-        cg.add(var.set_blue_xy(xy[0], xy[1]))
+    if CONF_PROFILE_BLUE_XY in config or CONF_PROFILE_BLUE_WAVELENGTH in config:
+        cg.add(var.set_blue_xy(b_xy[0], b_xy[1]))
 
     if CONF_PROFILE_BLUE_INTENSITY in config:
         i = config[CONF_PROFILE_BLUE_INTENSITY]
@@ -183,10 +201,17 @@ async def to_rgb_profile_code(config):
     if CONF_PROFILE_WHITE_POINT_COLOR_TEMPERATURE in config:
         k = config[CONF_PROFILE_WHITE_POINT_COLOR_TEMPERATURE]
         cg.add(var.set_white_point_cct(k))
+        w_xy = cie.mired_to_xy(k)
 
     if CONF_PROFILE_WHITE_POINT_XY in config:
         xy = config[CONF_PROFILE_WHITE_POINT_XY]
         cg.add(var.set_white_point_xy(xy[0], xy[1]))
+        w_xy = xy
+
+    # Bake the transform matrices at build time, so the device never has to invert them.
+    # This must come last, as the setters above discard any existing matrices
+    (RGB2XYZ, XYZ2RGB) = to_transform_matrices_expressions(r_xy, g_xy, b_xy, w_xy)
+    cg.add(var.set_transform_matrices(RGB2XYZ, XYZ2RGB))
     
     await cg.register_component(var, config)
     
\ No newline at end of file
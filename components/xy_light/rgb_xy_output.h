@@ -4,6 +4,7 @@
 #include "esphome/core/component.h"
 #include "esphome/components/output/float_output.h"
 
+#include "esphome/components/xy_light/calibration_telemetry.h"
 #include "esphome/components/xy_light/xy_output.h"
 #include "esphome/components/xy_light/color_spaces.h"
 #include "esphome/components/xy_light/rgb_profile.h"
@@ -15,42 +16,85 @@ namespace xy_light {
 class RgbXyOutput : public Component, public XyOutput {
  protected:
   bool _calibration_logging = false;
-  output::FloatOutput *_r = NULL;
-  output::FloatOutput *_g = NULL;
-  output::FloatOutput *_b = NULL;
+  XyChannel _r{"red"};
+  XyChannel _g{"green"};
+  XyChannel _b{"blue"};
+
+  // Source linear RGB to this output's linear RGB, white balance included
+  optional<matrices::Matrix3x3> _source_to_rgb;
 
  public:
   RgbChromaTransform rgb_profile_transform;
 
   void set_color_XYZ(float X, float Y, float Z) override {
-    auto rgb = this->rgb_profile_transform.XYZ_to_RGB(color_space::XYZ_Cie1931(X, Y, Z));
+    this->write_rgb(this->rgb_profile_transform.XYZ_to_RGB(color_space::XYZ_Cie1931(X, Y, Z)));
+  }
 
-    if (this->_calibration_logging)
-      this->log_calibration_data(rgb);
+  void set_source_transform(const matrices::Matrix3x3 &source_transform) override {
+    XyOutput::set_source_transform(source_transform);
+    this->_source_to_rgb.reset();
+  }
 
-    rgb = rgb.clamp_truncate();
-    if (this->_r)
-      this->_r->set_level(rgb.r);
+  // One mat-vec from source to output RGB, rather than going via XYZ
+  void set_color_linear_RGB(float r, float g, float b) override {
+    if (!this->_source_to_rgb.has_value()) {
+      this->_source_to_rgb =
+          this->rgb_profile_transform.Cie1931XYZ_2_rgb_transform_matrix() * this->_source_transform;
+    }
 
-    if (this->_g)
-      this->_g->set_level(rgb.g);
+    auto rgb = this->_source_to_rgb.value() * matrices::Vec3(r, g, b);
+    this->write_rgb(this->rgb_profile_transform.linear_RGB_to_RGB(color_space::RGB(rgb.x, rgb.y, rgb.z)));
+  }
+
+  void set_color_XYZ_fixed(const fixed_point::Vec3 &XYZ) override {
+    auto rgb = this->rgb_profile_transform.XYZ_to_RGB_fixed(XYZ);
 
-    if (this->_b)
-      this->_b->set_level(rgb.b);
+    if (this->_calibration_logging)
+      this->log_calibration_data(color_space::RGB::from_fixed(rgb));
+
+    this->write_level(this->_r, rgb.x);
+    this->write_level(this->_g, rgb.y);
+    this->write_level(this->_b, rgb.z);
+    this->commit_frame();
   }
 
   void enable_calibration_logging(bool enable) { this->_calibration_logging = enable; }
 
-  void set_color_profile(RgbProfile *profile) { this->rgb_profile_transform = profile->get_chroma_transform(); }
+  std::vector<XyChannel *> channels() override { return {&this->_r, &this->_g, &this->_b}; }
 
-  void set_red_output(output::FloatOutput *red) { this->_r = red; }
+  optional<color_space::XYZ_Cie1931> levels_to_XYZ(const float *levels) override {
+    return this->rgb_profile_transform.RGB_to_XYZ(color_space::RGB(levels[0], levels[1], levels[2]));
+  }
 
-  void set_green_output(output::FloatOutput *green) { this->_g = green; }
+  void set_color_profile(RgbProfile *profile) {
+    this->rgb_profile_transform = profile->get_chroma_transform();
+    this->_source_to_rgb.reset();
+  }
+
+  void set_red_output(output::FloatOutput *red) { this->_r.output = red; }
+
+  void set_green_output(output::FloatOutput *green) { this->_g.output = green; }
 
-  void set_blue_output(output::FloatOutput *blue) { this->_b = blue; }
+  void set_blue_output(output::FloatOutput *blue) { this->_b.output = blue; }
 
  private:
+  void write_rgb(color_space::RGB rgb) {
+    if (this->_calibration_logging && !this->capturing())
+      this->log_calibration_data(rgb);
+
+    rgb = rgb.clamp_truncate();
+    this->write_level(this->_r, rgb.r);
+    this->write_level(this->_g, rgb.g);
+    this->write_level(this->_b, rgb.b);
+    this->commit_frame();
+  }
+
   static void log_calibration_data(color_space::RGB rgb) {
+    CalibrationTelemetry::instance()->push(&RgbXyOutput::format_calibration_data, {rgb.r, rgb.g, rgb.b});
+  }
+
+  static void format_calibration_data(const float *values) {
+    auto rgb = color_space::RGB(values[0], values[1], values[2]);
     auto rgb_max = rgb.max();
 
     ESP_LOGI("output.rgb_xy_output", "Normalized: [R %.2f%%, G %.2f%%, B %.2f%%] Actual: [R %.2f%%, G %.2f%%, B %.2f%%]",
@@ -2,6 +2,7 @@
 #include "esphome/core/log.h"
 #include "esphome/core/component.h"
 #include "esphome/components/output/float_output.h"
+#include "esphome/components/xy_light/calibration_telemetry.h"
 #include "esphome/components/xy_light/xy_output.h"
 #include "esphome/components/xy_light/color_spaces.h"
 #include "esphome/components/xy_light/rgb_profile.h"
@@ -14,10 +15,10 @@ class RgbwXyOutput : public Component, public XyOutput {
  protected:
   bool _calibration_logging = false;
 
-  output::FloatOutput *_r = NULL;
-  output::FloatOutput *_g = NULL;
-  output::FloatOutput *_b = NULL;
-  output::FloatOutput *_w = NULL;
+  XyChannel _r{"red"};
+  XyChannel _g{"green"};
+  XyChannel _b{"blue"};
+  XyChannel _w{"white"};
 
  public:
   RgbChromaTransform rgb_profile_transform;
@@ -25,43 +26,77 @@ class RgbwXyOutput : public Component, public XyOutput {
 
   void set_color_XYZ(float X, float Y, float Z) override {
     auto XYZ = color_space::XYZ_Cie1931(X, Y, Z);
-    auto rgb = this->rgb_profile_transform.XYZ_to_RGB(XYZ);
-    auto w = this->white_profile_transform.XYZ_to_white_intensity(XYZ);
-
-    if (this->_calibration_logging)
-      this->log_calibration_data(rgb, w);
+    this->write_rgbw(this->rgb_profile_transform.XYZ_to_RGB(XYZ),
+                     this->white_profile_transform.XYZ_to_white_intensity(XYZ));
+  }
 
-    rgb = rgb.clamp_truncate();
+  void set_color_CT(const XyCtFrame &ct, float r, float g, float b) override {
+    auto XYZ = this->_source_transform * matrices::Vec3(r, g, b);
+    this->set_color_CT_XYZ(ct, XYZ.x, XYZ.y, XYZ.z);
+  }
 
-    if (this->_r)
-      this->_r->set_level(rgb.r);
+  void set_color_CT_XYZ(const XyCtFrame &ct, float X, float Y, float Z) override {
+    this->write_rgbw(this->rgb_profile_transform.XYZ_to_RGB(color_space::XYZ_Cie1931(X, Y, Z)),
+                     this->white_profile_transform.CT_to_white_intensity(ct.mired, ct.Y));
+  }
 
-    if (this->_g)
-      this->_g->set_level(rgb.g);
+  void set_color_XYZ_fixed(const fixed_point::Vec3 &XYZ) override {
+    auto rgb = this->rgb_profile_transform.XYZ_to_RGB_fixed(XYZ);
+    auto w = this->white_profile_transform.XYZ_to_white_intensity(color_space::XYZ_Cie1931::from_fixed(XYZ));
 
-    if (this->_b)
-      this->_b->set_level(rgb.b);
+    if (this->_calibration_logging)
+      this->log_calibration_data(color_space::RGB::from_fixed(rgb), w);
 
-    if (this->_w)
-      this->_w->set_level(color_space::clamp_output_value(w));
+    this->write_level(this->_r, rgb.x);
+    this->write_level(this->_g, rgb.y);
+    this->write_level(this->_b, rgb.z);
+    this->write_level(this->_w, fixed_point::from_float(color_space::clamp_output_value(w)));
+    this->commit_frame();
   }
 
   void enable_calibration_logging(bool enable) { this->_calibration_logging = enable; }
 
+  std::vector<XyChannel *> channels() override { return {&this->_r, &this->_g, &this->_b, &this->_w}; }
+
+  optional<color_space::XYZ_Cie1931> levels_to_XYZ(const float *levels) override {
+    auto rgb = this->rgb_profile_transform.RGB_to_XYZ(color_space::RGB(levels[0], levels[1], levels[2]));
+    auto w = this->white_profile_transform.white_intensity_to_XYZ(levels[3]);
+    return color_space::XYZ_Cie1931(rgb.X + w.X, rgb.Y + w.Y, rgb.Z + w.Z);
+  }
+
   void set_color_profile(RgbProfile *profile) { this->rgb_profile_transform = profile->get_chroma_transform(); }
 
   void set_white_profile(WhiteProfile *profile) { this->white_profile_transform = profile->get_chroma_transform(); }
 
-  void set_red_output(output::FloatOutput *red) { this->_r = red; }
+  void set_red_output(output::FloatOutput *red) { this->_r.output = red; }
 
-  void set_green_output(output::FloatOutput *green) { this->_g = green; }
+  void set_green_output(output::FloatOutput *green) { this->_g.output = green; }
 
-  void set_blue_output(output::FloatOutput *blue) { this->_b = blue; }
+  void set_blue_output(output::FloatOutput *blue) { this->_b.output = blue; }
 
-  void set_white_output(output::FloatOutput *w) { this->_w = w; }
+  void set_white_output(output::FloatOutput *w) { this->_w.output = w; }
 
  private:
+  void write_rgbw(color_space::RGB rgb, float w) {
+    if (this->_calibration_logging && !this->capturing())
+      this->log_calibration_data(rgb, w);
+
+    rgb = rgb.clamp_truncate();
+
+    this->write_level(this->_r, rgb.r);
+    this->write_level(this->_g, rgb.g);
+    this->write_level(this->_b, rgb.b);
+    this->write_level(this->_w, color_space::clamp_output_value(w));
+    this->commit_frame();
+  }
+
   static void log_calibration_data(color_space::RGB rgb, float w) {
+    CalibrationTelemetry::instance()->push(&RgbwXyOutput::format_calibration_data, {rgb.r, rgb.g, rgb.b, w});
+  }
+
+  static void format_calibration_data(const float *values) {
+    auto rgb = color_space::RGB(values[0], values[1], values[2]);
+    auto w = values[3];
     auto rgb_max = rgb.max();
     ESP_LOGI("output.rgb_w_xy_output", "Normalized: [R %.2f%%, G %.2f%%, B %.2f%%, W %.2f%%] Actual: [R %.2f%%, G %.2f%%, B %.2f%%, W %.2f%%]",
           (rgb.r / rgb_max) * 100.0f, 
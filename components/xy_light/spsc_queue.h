@@ -0,0 +1,49 @@
+#pragma once
+#include <atomic>
+#include <stddef.h>
+
+namespace esphome {
+namespace xy_light {
+
+// Fixed size lock-free queue for exactly one producer and one consumer thread (or task). Holds CAPACITY - 1 items,
+// as one slot is kept free to tell a full queue from an empty one.
+template<typename T, size_t CAPACITY> class SpscQueue {
+ public:
+  bool push(const T &item) {
+    auto head = this->_head.load(std::memory_order_relaxed);
+    auto next = (head + 1) % CAPACITY;
+    if (next == this->_tail.load(std::memory_order_acquire))
+      return false;
+
+    this->_items[head] = item;
+    this->_head.store(next, std::memory_order_release);
+    return true;
+  }
+
+  bool pop(T &item) {
+    auto tail = this->_tail.load(std::memory_order_relaxed);
+    if (tail == this->_head.load(std::memory_order_acquire))
+      return false;
+
+    item = this->_items[tail];
+    this->_tail.store((tail + 1) % CAPACITY, std::memory_order_release);
+    return true;
+  }
+
+  // Approximate when called from a thread other than the producer or consumer
+  size_t size() const {
+    auto head = this->_head.load(std::memory_order_acquire);
+    auto tail = this->_tail.load(std::memory_order_acquire);
+    return (head + CAPACITY - tail) % CAPACITY;
+  }
+
+  bool empty() const { return this->size() == 0; }
+
+ protected:
+  T _items[CAPACITY];
+  std::atomic<size_t> _head{0};
+  std::atomic<size_t> _tail{0};
+};
+
+}  // namespace xy_light
+}  // namespace esphome
@@ -0,0 +1,84 @@
+#include "esphome/components/xy_light/transfer_function.h"
+
+using namespace esphome::xy_light::color_space;
+
+TransferFunction::TransferFunction(Fn fn, float param, size_t size, TransferInterpolation interpolation)
+    : _fn(fn), _param(param) {
+  if (size < 2)
+    size = 2;
+
+  auto table = std::make_shared<Table>();
+  auto last = size - 1;
+  table->values.resize(size);
+  for (size_t i = 0; i < size; i++) {
+    table->values[i] = fn((double) i / (double) last, param);
+  }
+
+  if (interpolation == TransferInterpolation::CUBIC) {
+    // Fritsch-Carlson, limits the tangents so the interpolated curve can not overshoot
+    auto &v = table->values;
+    auto &m = table->slopes;
+    m.resize(size);
+    m[0] = v[1] - v[0];
+    m[last] = v[last] - v[last - 1];
+    for (size_t i = 1; i < last; i++) {
+      auto d0 = v[i] - v[i - 1];
+      auto d1 = v[i + 1] - v[i];
+      m[i] = (d0 * d1) <= 0.0f ? 0.0f : (d0 + d1) / 2.0f;
+    }
+
+    for (size_t i = 0; i < last; i++) {
+      auto d = v[i + 1] - v[i];
+      if (d == 0.0f) {
+        m[i] = 0.0f;
+        m[i + 1] = 0.0f;
+        continue;
+      }
+
+      auto a = m[i] / d;
+      auto b = m[i + 1] / d;
+      auto h = (a * a) + (b * b);
+      if (h > 9.0f) {
+        auto tau = 3.0f / sqrtf(h);
+        m[i] = tau * a * d;
+        m[i + 1] = tau * b * d;
+      }
+    }
+  }
+
+  this->_table = table;
+
+  // A table can not follow the steep toe of some curves, find the first knot above which
+  // every interval is within tolerance (sampled at its quarter points) and evaluate below it exactly
+  this->_table_min = 0.0f;
+  size_t exact_intervals = 0;
+  for (size_t i = 0; i < last; i++) {
+    for (float t = 0.25f; t < 1.0f; t += 0.25f) {
+      auto x = ((float) i + t) / (float) last;
+      if (fabsf((*this)(x) - fn(x, param)) > MAX_TABLE_ERROR)
+        exact_intervals = i + 1;
+    }
+  }
+  this->_table_min = (float) exact_intervals / (float) last;
+}
+
+TransferFunction TransferFunction::exp_gamma_compress(float gamma, size_t size, TransferInterpolation interpolation) {
+  if (gamma == 1.0f || gamma <= 0.0f)
+    return TransferFunction::positive();
+  return TransferFunction(color_space::exp_gamma_compress, gamma, size, interpolation);
+}
+
+TransferFunction TransferFunction::exp_gamma_decompress(float gamma, size_t size, TransferInterpolation interpolation) {
+  if (gamma == 1.0f || gamma <= 0.0f)
+    return TransferFunction::positive();
+  return TransferFunction(color_space::exp_gamma_decompress, gamma, size, interpolation);
+}
+
+TransferFunction TransferFunction::srgb_gamma_compress(float gamma, size_t size, TransferInterpolation interpolation) {
+  return TransferFunction(color_space::srgb_gamma_compress, gamma, size, interpolation);
+}
+
+TransferFunction TransferFunction::srgb_gamma_decompress(float gamma, size_t size,
+                                                         TransferInterpolation interpolation) {
+  return TransferFunction(color_space::srgb_gamma_decompress, gamma, size, interpolation);
+}
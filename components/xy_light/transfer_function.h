@@ -0,0 +1,166 @@
+#pragma once
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <memory>
+#include <vector>
+
+#include "esphome/components/xy_light/fixed_point.h"
+
+namespace esphome {
+namespace xy_light {
+namespace color_space {
+
+static float exp_gamma_compress(float linear, float gamma) {
+  if (linear <= 0.0f)
+    return 0.0f;
+  if (gamma == 1.0f || gamma <= 0.0f)
+    return linear;
+  return powf(linear, 1.0f / gamma);
+}
+
+static float exp_gamma_decompress(float value, float gamma) {
+  if (value <= 0.0f)
+    return 0.0f;
+  if (gamma == 1.0f || gamma <= 0.0f)
+    return value;
+
+  return powf(value, gamma);
+}
+
+static float srgb_gamma_compress(float linear, float gamma) {
+    if (linear <= 0.0031308f) {
+        return 12.92 * linear;
+    } else {
+        return 1.055 * powf(linear, 1.0f / gamma) - 0.055f;
+    }
+}
+static float srgb_gamma_decompress(float sRGB, float gamma) {
+    if (sRGB <= 0.04045f) {
+        return sRGB / 12.92f;
+    } else {
+        return powf((sRGB + 0.055f) / 1.055f, gamma);
+    }
+}
+
+enum class TransferInterpolation : uint8_t {
+  LINEAR,
+  // Monotone cubic Hermite (Fritsch-Carlson), twice the memory of LINEAR
+  CUBIC
+};
+
+// Lookup table for a monotone transfer function (gamma curves, power law attenuation etc) over [0, 1].
+// Built once when a profile is configured, and then evaluated per frame without calling powf.
+// Values outside of [0, 1] fall through to the exact function, as do values below the first knot from which
+// interpolation stays within MAX_TABLE_ERROR (ie the steep toe of curves with exponents below 1).
+// Copies share the same table.
+class TransferFunction {
+ public:
+  typedef float (*Fn)(float, float);
+
+  static const size_t DEFAULT_SIZE = 256;
+
+  // ~0.4 of a step at 12 bit PWM resolution
+  static constexpr float MAX_TABLE_ERROR = 1e-4f;
+
+  // Identity
+  TransferFunction() {}
+
+  TransferFunction(Fn fn, float param, size_t size = DEFAULT_SIZE,
+                   TransferInterpolation interpolation = TransferInterpolation::LINEAR);
+
+  // Evaluated by calling the function, without a table
+  static TransferFunction exact(Fn fn, float param) {
+    TransferFunction f;
+    f._fn = fn;
+    f._param = param;
+    return f;
+  }
+
+  // Identity for positive values, zero otherwise (ie a power law with an exponent of 1)
+  static TransferFunction positive() {
+    TransferFunction f;
+    f._clamp_negative = true;
+    return f;
+  }
+
+  static TransferFunction exp_gamma_compress(float gamma, size_t size = DEFAULT_SIZE,
+                                             TransferInterpolation interpolation = TransferInterpolation::LINEAR);
+
+  static TransferFunction exp_gamma_decompress(float gamma, size_t size = DEFAULT_SIZE,
+                                               TransferInterpolation interpolation = TransferInterpolation::LINEAR);
+
+  static TransferFunction srgb_gamma_compress(float gamma, size_t size = DEFAULT_SIZE,
+                                              TransferInterpolation interpolation = TransferInterpolation::LINEAR);
+
+  static TransferFunction srgb_gamma_decompress(float gamma, size_t size = DEFAULT_SIZE,
+                                                TransferInterpolation interpolation = TransferInterpolation::LINEAR);
+
+  float operator()(float x) const {
+    if (!this->_table) {
+      if (this->_fn)
+        return this->_fn(x, this->_param);
+      return (this->_clamp_negative && x <= 0.0f) ? 0.0f : x;
+    }
+
+    // Note: negated compare so NaN also takes the exact path
+    if (!(x >= this->_table_min && x <= 1.0f))
+      return this->_fn(x, this->_param);
+
+    auto &values = this->_table->values;
+    auto last = values.size() - 1;
+    auto pos = x * (float) last;
+    auto i = (size_t) pos;
+    if (i >= last)
+      i = last - 1;
+
+    auto t = pos - (float) i;
+    auto v0 = values[i];
+    auto v1 = values[i + 1];
+
+    if (this->_table->slopes.empty())
+      return v0 + ((v1 - v0) * t);
+
+    // Hermite basis, slopes are stored pre-scaled by the knot spacing
+    auto &slopes = this->_table->slopes;
+    auto t2 = t * t;
+    auto t3 = t2 * t;
+    return (((2.0f * t3) - (3.0f * t2) + 1.0f) * v0) + ((t3 - (2.0f * t2) + t) * slopes[i]) +
+           (((-2.0f * t3) + (3.0f * t2)) * v1) + ((t3 - t2) * slopes[i + 1]);
+  }
+
+  // Fixed point evaluation. Identity functions stay in integer math, anything else goes through the float path.
+  fixed_point::fixed_t eval_fixed(fixed_point::fixed_t x) const {
+    if (!this->_table && !this->_fn)
+      return (this->_clamp_negative && x <= 0) ? 0 : x;
+    return fixed_point::from_float((*this)(fixed_point::to_float(x)));
+  }
+
+  // True when evaluation is a passthrough or a trivial exact function call, ie has no table
+  bool is_trivial() const { return !this->_table; }
+
+  size_t size() const { return this->_table ? this->_table->values.size() : 0; }
+
+  // Inputs below this are evaluated exactly
+  float table_min() const { return this->_table ? this->_table_min : 1.0f; }
+
+  size_t memory_usage() const {
+    return this->_table ? (this->_table->values.size() + this->_table->slopes.size()) * sizeof(float) : 0;
+  }
+
+ protected:
+  struct Table {
+    std::vector<float> values;
+    std::vector<float> slopes;
+  };
+
+  Fn _fn = nullptr;
+  float _param = 0.0f;
+  float _table_min = 0.0f;
+  bool _clamp_negative = false;
+  std::shared_ptr<const Table> _table;
+};
+
+}  // namespace color_space
+}  // namespace xy_light
+}  // namespace esphome
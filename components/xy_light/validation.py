@@ -1,4 +1,6 @@
 import esphome.config_validation as cv
+import esphome.final_validate as fv
+from esphome.core import CORE
 
 def cie_xy(value):
     if isinstance(value, list):
@@ -56,6 +58,14 @@ def duv(value):
         "Invalid value '{}' for Delta uv. Only values between 0.0 and 0.8 is allowed."
     )
 
+def uv_lut_grid_size(value):
+    # 8 bytes per point, ie 32KB at 64, and kept to 8KB on the ESP8266's much smaller heap
+    value = cv.int_range(min=8, max=64)(value)
+    if CORE.is_esp8266 and value > 32:
+        raise cv.Invalid("uv_lut_grid_size can be at most 32 on ESP8266")
+    return value
+
+
 _wavelength_unit = cv.float_with_unit("Wavelength", r"(nanometers|nm|)")
 
 def wavelength(value):
@@ -66,4 +76,19 @@ def wavelength(value):
         raise cv.Invalid("Wavelength must at most be less the 830nm")
 
     # convert wavelength to xy value
-    return nm
\ No newline at end of file
+    return nm
+
+
+def table_memory_limit():
+    # Heap the lookup tables of one light (or profile) may allocate on the target, or None when unlimited.
+    # ESP8266s have ~40KB of heap in total, and ESP32s without PSRAM can rarely allocate much over 100KB at once.
+    # Only usable from a FINAL_VALIDATE_SCHEMA, as it looks for a psram component.
+    if CORE.is_host:
+        return None
+    if CORE.is_esp8266:
+        return 16 * 1024
+    if CORE.is_esp32:
+        if "psram" in fv.full_config.get():
+            return 2 * 1024 * 1024
+        return 96 * 1024
+    return 64 * 1024
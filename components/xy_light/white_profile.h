@@ -3,6 +3,7 @@
 #include "esphome/core/log.h"
 #include "esphome/components/logger/logger.h"
 #include "esphome/components/xy_light/color_spaces.h"
+#include "esphome/components/xy_light/profiling.h"
 
 namespace esphome {
 namespace xy_light {
@@ -35,8 +36,17 @@ class WhiteChromaTransform {
   //  - and will have less obvious shifts in brightness when moving between green/purple to red/blue/white hues
   float _impurity_attn_decay_gamma = 1.5f;
 
+  color_space::TransferFunction _gamma_compress = color_space::TransferFunction::exp_gamma_compress(1.00f);
+  color_space::TransferFunction _gamma_decompress = color_space::TransferFunction::exp_gamma_decompress(1.00f);
+  color_space::TransferFunction _impurity_attn_decay =
+      color_space::TransferFunction::exp_gamma_decompress(this->_impurity_attn_decay_gamma);
+
  public:
-  void set_gamma(float g) { this->_gamma = g; }
+  void set_gamma(float g) {
+    this->_gamma = g;
+    this->_gamma_compress = color_space::TransferFunction::exp_gamma_compress(g);
+    this->_gamma_decompress = color_space::TransferFunction::exp_gamma_decompress(g);
+  }
 
   void set_white_point(float mired) {
     auto wp = color_space::ColorTemperature::from_mired(mired);
@@ -45,6 +55,13 @@ class WhiteChromaTransform {
     this->_blue_wb_impurity_k = wp.sub_mired(this->_blue_wb_impurity_threshold_mired).as_kelvin();
   }
 
+  // Light of the white channel at the given (gamma compressed) intensity
+  color_space::XYZ_Cie1931 white_intensity_to_XYZ(float i) {
+    auto p = color_space::PlanckianLocus::at_kelvin(this->_white_point_k);
+    auto Y = this->_gamma_decompress(clamp(i, 0.0f, 1.0f));
+    return color_space::Uv_Cie1960(p.u, p.v).as_xy_cie1931().as_XYZ_cie1931(Y);
+  }
+
   void set_red_wb_impurity(float mired) {
     this->_red_wb_impurity_k = color_space::ColorTemperature::from_kelvin(this->_white_point_k)
                                    .add_mired(this->_red_wb_impurity_threshold_mired)
@@ -61,13 +78,15 @@ class WhiteChromaTransform {
 
   void set_purple_tint_duv_impurity(float duv) { this->_purple_tint_duv_impurity = duv; }
 
-  void set_impurity_decay_gamma(float g) { this->_impurity_attn_decay_gamma = g; }
+  void set_impurity_decay_gamma(float g) {
+    this->_impurity_attn_decay_gamma = g;
+    this->_impurity_attn_decay = color_space::TransferFunction::exp_gamma_decompress(g);
+  }
 
  private:
-  float tint_impurity_attenuation_factor(color_space::xyY_Cie1931 t_xyY) {
-    return color_space::Xy_Cie1931(t_xyY.x, t_xyY.y)
-        .as_uv_cie1960()
-        .tint_impurity(this->_green_tint_duv_impurity, this->_purple_tint_duv_impurity);
+  float tint_impurity_attenuation_factor(color_space::CctDuv cct_duv) {
+    return color_space::Uv_Cie1960::tint_impurity(cct_duv, this->_green_tint_duv_impurity,
+                                                  this->_purple_tint_duv_impurity);
   }
 
   float wb_impurity_attenuation_factor(float k) {
@@ -84,15 +103,24 @@ class WhiteChromaTransform {
   float XYZ_to_white_intensity(color_space::XYZ_Cie1931 XYZ) {
     auto t_xyY = XYZ.as_xyY_cie1931();
 
+    // CCT and Duv in a single pass
+    return this->CctDuv_to_white_intensity(t_xyY.as_xy_cie1931().as_uv_cie1960().cct_duv(), t_xyY.Y);
+  }
+
+  // A colour temperature on the locus, which needs no CCT / Duv solve
+  float CT_to_white_intensity(float mired, float Y) {
+    return this->CctDuv_to_white_intensity(color_space::PlanckianLocus::on_locus(mired), Y);
+  }
+
+  float CctDuv_to_white_intensity(color_space::CctDuv cct_duv, float Y) {
     // Reduce the brightness the future the target colour is from the planckian locus
-    auto tint_impurity_attn = this->tint_impurity_attenuation_factor(t_xyY);
+    auto tint_impurity_attn = this->tint_impurity_attenuation_factor(cct_duv);
 
-    // Exit early if we can, as calculating approximate color temp is very cpu intensive
     if (tint_impurity_attn == 0.0f) {
       return 0.0f;
     }
 
-    auto k = t_xyY.cct_kelvin_approx();
+    auto k = 1000000.0f / cct_duv.mired;
     auto wb_impurity_attn = this->wb_impurity_attenuation_factor(k);
 
     // Rather then multiplying the attenuations, take the smallest of the two.
@@ -103,8 +131,9 @@ class WhiteChromaTransform {
       return 0.0f;
     }
 
-    auto brightness = powf(impurity_attn, this->_impurity_attn_decay_gamma) * t_xyY.Y;
-    return color_space::exp_gamma_compress(brightness, this->_gamma);
+    auto brightness = this->_impurity_attn_decay(impurity_attn) * Y;
+    XY_PROFILE_STAGE(PROFILE_CALIBRATION);
+    return this->_gamma_compress(brightness);
   }
 };
 
@@ -3,6 +3,7 @@
 #include "esphome/core/component.h"
 #include "esphome/components/output/float_output.h"
 
+#include "esphome/components/xy_light/calibration_telemetry.h"
 #include "esphome/components/xy_light/xy_output.h"
 #include "esphome/components/xy_light/color_spaces.h"
 #include "esphome/components/xy_light/white_profile.h"
@@ -14,7 +15,7 @@ class WhiteXyOutput : public Component, public XyOutput {
  protected:
 
   bool _calibration_logging = false;
-  output::FloatOutput *_white = NULL;
+  XyChannel _white{"white"};
 
  public:
 
@@ -22,22 +23,56 @@ class WhiteXyOutput : public Component, public XyOutput {
 
   void set_color_XYZ(float X, float Y, float Z) override {
     auto XYZ = color_space::XYZ_Cie1931(X, Y, Z);
-    auto w = this->white_profile_transform.XYZ_to_white_intensity(XYZ);
+    this->write_white(this->white_profile_transform.XYZ_to_white_intensity(XYZ));
+  }
+
+  void set_color_CT(const XyCtFrame &ct, float /*r*/, float /*g*/, float /*b*/) override {
+    this->write_white(this->white_profile_transform.CT_to_white_intensity(ct.mired, ct.Y));
+  }
+
+  void set_color_CT_XYZ(const XyCtFrame &ct, float /*X*/, float /*Y*/, float /*Z*/) override {
+    this->write_white(this->white_profile_transform.CT_to_white_intensity(ct.mired, ct.Y));
+  }
+
+  void set_color_XYZ_fixed(const fixed_point::Vec3 &XYZ) override {
+    auto w = this->white_profile_transform.XYZ_to_white_intensity(color_space::XYZ_Cie1931::from_fixed(XYZ));
 
     if (this->_calibration_logging)
       this->log_calibration_data(w);
 
-    if (this->_white)
-      this->_white->set_level(color_space::clamp_output_value(w));
+    this->write_level(this->_white, fixed_point::from_float(color_space::clamp_output_value(w)));
+    this->commit_frame();
   }
 
   void enable_calibration_logging(bool enable) { this->_calibration_logging = enable; }
 
+  std::vector<XyChannel *> channels() override { return {&this->_white}; }
+
+  optional<color_space::XYZ_Cie1931> levels_to_XYZ(const float *levels) override {
+    return this->white_profile_transform.white_intensity_to_XYZ(levels[0]);
+  }
+
   void set_profile(WhiteProfile *profile) { this->white_profile_transform = profile->get_chroma_transform(); }
 
-  void set_white_output(output::FloatOutput *white) { this->_white = _white; }
+  void set_white_output(output::FloatOutput *white) { this->_white.output = white; }
 
-  static void log_calibration_data(float i) { ESP_LOGI("output.white_xy_output", "intensity: %.0f%%", i * 100); }
+ protected:
+  void write_white(float w) {
+    if (this->_calibration_logging && !this->capturing())
+      this->log_calibration_data(w);
+
+    this->write_level(this->_white, color_space::clamp_output_value(w));
+    this->commit_frame();
+  }
+
+ public:
+  static void log_calibration_data(float i) {
+    CalibrationTelemetry::instance()->push(&WhiteXyOutput::format_calibration_data, {i});
+  }
+
+  static void format_calibration_data(const float *values) {
+    ESP_LOGI("output.white_xy_output", "intensity: %.0f%%", values[0] * 100);
+  }
 };
 
 }  // namespace xy_light
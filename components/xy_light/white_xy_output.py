@@ -6,7 +6,9 @@ from esphome.const import CONF_ID
 from .xy_output import (xy_light_ns, XyOutput)
 from .white_profile import (WHITE_PROFILE_CONFIG_SCHEMA, WhiteProfile, to_white_profile_code)
 
-from .xy_output import CONF_XY_OUTPUT_CALIBRATION_LOGGING
+from .xy_output import (CONF_XY_OUTPUT_CALIBRATION_LOGGING, to_calibration_logging_code)
+from .xy_output import CONF_XY_OUTPUT_BIT_DEPTH
+from .xy_output import (CONF_XY_OUTPUT_FRAME_SINK_ID, XyFrameSink)
 from .xy_output import (CONF_XY_OUTPUT_WHITE_COLOR_PROFILE_ID, CONF_XY_OUTPUT_WHITE_COLOR_PROFILE)
 from .xy_output import CONF_XY_OUTPUT_WHITE_OUTPUT_ID
 from .xy_output import CONF_XY_OUTPUT_CALIBRATION_LOGGING
@@ -16,6 +18,12 @@ WhiteXyOutput = xy_light_ns.class_("WhiteXyOutput", cg.Component, XyOutput)
 WHITE_XY_OUTPUT_CONFIG_SCHEMA = cv.Schema({ 
         cv.GenerateID(CONF_ID): cv.declare_id(WhiteXyOutput),
         cv.Optional(CONF_XY_OUTPUT_CALIBRATION_LOGGING): cv.boolean,
+
+        # Resolution of the outputs, writes which round to the same duty are skipped
+        cv.Optional(CONF_XY_OUTPUT_BIT_DEPTH): cv.int_range(min=1, max=16),
+
+        # Commits all channels of a frame at once, rather than one set_level() per channel
+        cv.Optional(CONF_XY_OUTPUT_FRAME_SINK_ID): cv.use_id(XyFrameSink),
         cv.Optional(CONF_XY_OUTPUT_WHITE_OUTPUT_ID): cv.use_id(output.FloatOutput),
         cv.Optional(CONF_XY_OUTPUT_WHITE_COLOR_PROFILE_ID): cv.use_id(WhiteProfile),
         cv.Optional(CONF_XY_OUTPUT_WHITE_COLOR_PROFILE): WHITE_PROFILE_CONFIG_SCHEMA,
@@ -43,6 +51,13 @@ async def to_white_xy_output_code(config):
     if CONF_XY_OUTPUT_CALIBRATION_LOGGING in config:     
         enable_cal_log = config[CONF_XY_OUTPUT_CALIBRATION_LOGGING]
         if enable_cal_log:
-            cg.add(var.enable_calibration_logging(True))   
+            await to_calibration_logging_code(var)
+
+    if CONF_XY_OUTPUT_BIT_DEPTH in config:
+        cg.add(var.set_bit_depth(config[CONF_XY_OUTPUT_BIT_DEPTH]))
+
+    if CONF_XY_OUTPUT_FRAME_SINK_ID in config:
+        sink = await cg.get_variable(config[CONF_XY_OUTPUT_FRAME_SINK_ID])
+        cg.add(var.set_frame_sink(sink))
 
     await cg.register_component(var, config)
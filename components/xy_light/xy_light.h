@@ -1,12 +1,24 @@
 #pragma once
 #include <set>
+#include <vector>
 #include "esphome/core/optional.h"
 #include "esphome/core/component.h"
+#include "esphome/core/hal.h"
+#include "esphome/core/helpers.h"
+#include "esphome/core/log.h"
 #include "esphome/components/light/light_output.h"
 #include "esphome/components/light/light_state.h"
+#include "esphome/components/light/transformers.h"
 #include "esphome/components/output/float_output.h"
 
+#include "esphome/components/xy_light/async_frame_writer.h"
+#include "esphome/components/xy_light/calibration_telemetry.h"
 #include "esphome/components/xy_light/color_spaces.h"
+#include "esphome/components/xy_light/command_trace.h"
+#include "esphome/components/xy_light/compositor.h"
+#include "esphome/components/xy_light/fixed_point.h"
+#include "esphome/components/xy_light/profiling.h"
+#include "esphome/components/xy_light/render_worker.h"
 #include "esphome/components/xy_light/rgb_profile.h"
 #include "esphome/components/xy_light/xy_output.h"
 
@@ -17,7 +29,55 @@ inline static bool almost_eq(float a, float b) {
     return fabs(a - b) < 0.005f;
 }
 
-class XyLightOutput {
+class XyLightControl;
+
+class XyLightOutput : public Component {
+ public:
+  // Stages of the colour pipeline which are cached between calls to apply()
+  enum Stage : uint8_t {
+    // Source RGB to linear RGB (or XYZ in fixed point)
+    STAGE_DECODE = 0,
+    // Chromaticity after saturation, before brightness
+    STAGE_SATURATION,
+    // White balance scale / matrix for the current white point
+    STAGE_WHITE_BALANCE,
+    // Brightness, white balance and output transforms, skipped entirely when nothing has changed
+    STAGE_OUTPUT,
+    STAGE_COUNT
+  };
+
+  struct StageCounter {
+    uint32_t hits = 0;
+    uint32_t misses = 0;
+  };
+
+  struct RenderCounters {
+    // Calls to request_apply() from the controls
+    uint32_t requests = 0;
+    // Times the outputs were rendered
+    uint32_t frames = 0;
+    // Requests folded into a frame which was already pending
+    uint32_t coalesced = 0;
+    // Loop iterations a pending frame was held back by the frame interval
+    uint32_t deferred = 0;
+    // Frames of a transition which were not rendered, as they could not be told apart from the last one rendered
+    uint32_t skipped = 0;
+
+    float skip_ratio() const { return this->frames ? (float) this->skipped / (float) this->frames : 0.0f; }
+  };
+
+  struct TransitionCounters {
+    uint32_t transitions = 0;
+    // Frames stepped at the render rate, and the transition values the controls were not rendered with as a result
+    uint32_t ticks = 0;
+    uint32_t skipped_writes = 0;
+    // Tick start against the render rate, and time taken to render each tick
+    uint32_t max_jitter_us = 0;
+    uint64_t total_jitter_us = 0;
+    uint32_t max_cost_us = 0;
+    uint64_t total_cost_us = 0;
+  };
+
  protected: 
 
   RgbChromaTransform _gamut_transform;
@@ -25,11 +85,100 @@ class XyLightOutput {
 
   std::vector<XyOutput *> _outputs;
 
-  float _brightness, _saturation = 1.0f;
+  float _brightness = 1.0f, _saturation = 1.0f;
   bool _calibration_logging = false;
+  bool _fixed_point = false;
+  uint8_t _lut_grid_size = 0;
+  // When the source transform last changed. The outputs' LUTs are rebuilt once it has settled, rather than on every
+  // frame of a colour temperature transition.
+  uint32_t _source_changed_ms = 0;
+
+  // Colour temperature the white point was last set from, so unchanged values skip the locus lookup
+  float _white_point_mired = NAN;
+  optional<matrices::Vec3> _white_balance = {};
+  optional<fixed_point::Vec3> _white_balance_fixed = {};
+  optional<matrices::Matrix3x3> _source_transform = {};
 
   color_space::RGB _rgb;
   optional<color_space::Xy_Cie1931> _xy = {};
+
+  // Each setter only discards the stages downstream of it, so for example a brightness fade
+  // reuses the decoded and saturated chromaticity
+  bool _output_dirty = true;
+  optional<color_space::RGB> _linear_rgb = {};
+  optional<color_space::xyY_Cie1931> _chroma = {};
+  optional<fixed_point::Vec3> _XYZ_fixed = {};
+  optional<fixed_point::Vec3> _chroma_fixed = {};
+  StageCounter _stage_counters[STAGE_COUNT];
+
+  CommandTrace *_command_trace = nullptr;
+
+  // When the controls have layers, each sets its own layer and apply() blends them, rather than the controls
+  // sharing the light's colour, white point and brightness
+  XyCompositor _compositor;
+
+  // When coalescing, controls only mark a frame as pending, and it is rendered once from loop() (at most every
+  // _frame_interval_ms), so several controls changing in the same loop iteration cost a single apply()
+  bool _coalesce = false;
+  bool _frame_pending = false;
+  uint32_t _frame_interval_ms = 0;
+  uint32_t _last_frame_ms = 0;
+  RenderCounters _render_counters;
+
+  // How the outputs are written on each tick of a stepped transition, following the path apply_frame() takes for
+  // both of its endpoints
+  enum TickPath : uint8_t {
+    // White balanced XYZ, in fixed point when enabled
+    TICK_XYZ = 0,
+    // Linear source RGB, for the outputs' fused transform or LUT. Only while the white point stays the same.
+    TICK_LINEAR_RGB,
+    // A colour temperature on the locus, which white channels take as is
+    TICK_CT,
+  };
+
+  // A colour as a stepped transition moves it, as white balanced XYZ at Y = 1 and lightness (Y ^ 1/gamma, so fades
+  // are even in brightness). Linear source RGB scaled to Y = 1 and the colour temperature are kept for their paths.
+  struct XyTransitionPoint {
+    TickPath path = TICK_XYZ;
+    matrices::Vec3 chroma;
+    matrices::Vec3 rgb;
+    float mired = NAN;
+    float lightness = 0.0f;
+  };
+
+  // With a render rate, transitions are stepped by the light at a fixed tick rather than rendered from each value
+  // the light state interpolates. The light is set to the target values as the transition starts, and both
+  // endpoints are worked out once, so each tick only adds the deltas and runs the output transforms. The last
+  // tick is an exact apply().
+  struct XyTransition {
+    XyTransitionPoint value;
+    XyTransitionPoint step;
+    // Only this control's values end the transition, any other control's are stepped towards
+    XyLightControl *owner;
+    uint32_t ticks_left;
+  };
+  // Brightness to and from lightness, for the gamma of the control which started the transition
+  float _transition_gamma = NAN;
+  color_space::TransferFunction _lightness_compress;
+  color_space::TransferFunction _lightness_decompress;
+  uint32_t _tick_us = 0;
+  uint32_t _last_tick_us = 0;
+  optional<XyTransition> _transition = {};
+  TransitionCounters _transition_counters;
+  HighFrequencyLoopRequester _high_frequency;
+
+  // Frames part way through a transition are skipped while within this colour difference (delta E*uv) of the last
+  // frame rendered, 0 to render all of them. The values a transition settles on are always rendered.
+  float _skip_delta_e = 0.0f;
+  bool _transitioning = false;
+  optional<color_space::Luv_Cie1976> _rendered_Luv = {};
+  // Counters at the start of the current transition, for its skip ratio
+  uint32_t _transition_start_frames = 0;
+  uint32_t _transition_start_skipped = 0;
+
+  // When offloaded, control values are queued to the worker, which renders the light on its own task
+  RenderWorker *_render_worker = nullptr;
+  friend class RenderWorker;
   
  public:
 
@@ -42,88 +191,881 @@ class XyLightOutput {
   void set_source_color_profile(RgbProfile *profile) {
     this->_gamut_transform = profile->get_chroma_transform(); 
     this->_white_point = this->_gamut_transform.get_white_point();
+    this->reset_source();
+    this->reset_white_balance();
+  }
+
+  // Build time transform matrices for the default (sRGB) source profile
+  void set_source_transform_matrices(const matrices::Matrix3x3 &RGB2XYZ, const matrices::Matrix3x3 &XYZ2RGB) {
+    this->_gamut_transform.set_transform_matrices(RGB2XYZ, XYZ2RGB);
+    this->reset_source();
+    this->reset_white_balance();
+  }
+
+  void add_output(XyOutput *output) {
+    output->set_lut_grid_size(this->_lut_grid_size);
+    this->_outputs.push_back(output);
+    this->_source_transform.reset();
+    this->_output_dirty = true;
   }
 
-  void add_output(XyOutput *output) { this->_outputs.push_back(output); }
+  static const uint32_t LUT_SETTLE_MS = 250;
+  static const uint32_t LUT_BUILD_BUDGET_US = 1000;
+
+  // Map linear source RGB to channel levels through a 3D LUT on each output, 0 to evaluate the pipeline exactly
+  void set_lut_grid_size(uint8_t grid_size) {
+    this->_lut_grid_size = grid_size;
+    for (auto output : this->_outputs) {
+      output->set_lut_grid_size(grid_size);
+    }
+    this->_output_dirty = true;
+  }
 
   void set_color_temperature_value(float mired) {
-    if(!this->_calibration_logging) {
+    if(!this->_calibration_logging && mired != this->_white_point_mired) {
       auto ct_uv_1960 = color_space::Cct::from_mireds(mired).uv;
       this->_white_point = ct_uv_1960.as_xy_cie1931();
+      this->reset_white_balance();
+      this->_white_point_mired = mired;
     }
   }
 
   void set_white_balance_xy(float x, float y) {
     if(!this->_calibration_logging) {
       this->_white_point = color_space::Xy_Cie1931(x, y);
+      this->reset_white_balance();
     }
   }
   
   void set_white_balance_illuminant(color_space::Cie2dColorSpace i) {
     if(!this->_calibration_logging) {
       this->_white_point = i.as_xy_cie1931();
+      this->reset_white_balance();
     }
   }
 
 
   void set_color_saturation_value(float i) {
+    if (i == this->_saturation)
+      return;
     this->_saturation = i;
+    this->_chroma.reset();
+    this->_chroma_fixed.reset();
+    this->_output_dirty = true;
   }
 
   void set_brightness_value(float i) {
+    if (i == this->_brightness)
+      return;
     this->_brightness = i;
+    this->_output_dirty = true;
   }
 
   void set_rgb_value(float r, float g, float b) {
+    if (r == this->_rgb.r && g == this->_rgb.g && b == this->_rgb.b)
+      return;
     this->_rgb = color_space::RGB(r,g,b);
+    this->reset_source();
   }
 
   void set_xy_value(float x, float y) {
     this->_xy = color_space::Xy_Cie1931(x, y);
+    this->reset_source();
   }
 
   void enable_calibration_logging(bool enable) { this->_calibration_logging = enable; }
 
+  // Records the colour values each control is written with
+  void set_command_trace(CommandTrace *trace) { this->_command_trace = trace; }
+  CommandTrace *get_command_trace() { return this->_command_trace; }
+
+  void enable_fixed_point(bool enable) {
+    this->_fixed_point = enable;
+    this->_output_dirty = true;
+  }
+
+  // Render once per loop iteration rather than on every control change
+  void enable_coalescing(bool enable) { this->_coalesce = enable; }
+
+  // Minimum time between frames while coalescing, 0 for once per loop iteration
+  void set_frame_interval(uint32_t ms) { this->_frame_interval_ms = ms; }
+
+  // Counted by the task which renders the light, so only read from it (or once the worker has stopped)
+  const RenderCounters &render_counters() const { return this->_render_counters; }
+
+  // Frames per second of stepped transitions, 0 to render every value of a transition as it is written
+  void set_render_rate(float hz) { this->_tick_us = hz > 0.0f ? (uint32_t) (1000000.0f / hz) : 0; }
+
+  const TransitionCounters &transition_counters() const { return this->_transition_counters; }
+
+  // Just noticeable difference for skipping frames of a transition, ie 1.0. 0 to disable.
+  void set_skip_delta_e(float delta_e) { this->_skip_delta_e = delta_e; }
+
+  // Starts stepping towards the values of a control's command over length_ms. Returns false when the light can not
+  // step transitions itself (no render rate, layers, offloaded or another control's transition is being stepped),
+  // and the control should write each value as usual.
+  bool begin_transition(const XyLightCommand &target, uint32_t length_ms, float gamma, XyLightControl *owner) {
+    if (this->_tick_us == 0 || this->layered() || this->_render_worker)
+      return false;
+    if (this->_transition.has_value() && this->_transition->owner != owner)
+      return false;
+
+    if (gamma != this->_transition_gamma) {
+      // An interrupted transition carries on from the same luminance
+      auto Y = this->_transition.has_value()
+                   ? this->_lightness_decompress(std::max(this->_transition->value.lightness, 0.0f))
+                   : 0.0f;
+      this->_transition_gamma = gamma;
+      this->_lightness_compress = color_space::TransferFunction::exp_gamma_compress(gamma);
+      this->_lightness_decompress = color_space::TransferFunction::exp_gamma_decompress(gamma);
+      if (this->_transition.has_value())
+        this->_transition->value.lightness = this->_lightness_compress(Y);
+    }
+
+    // From the colour being shown, which is part way through the last transition if it was interrupted
+    auto from = this->_transition.has_value() ? this->_transition->value : this->transition_point();
+    XyTransition t;
+    t.owner = owner;
+    t.ticks_left = (uint32_t) std::min<uint64_t>(
+        UINT32_MAX, std::max<uint64_t>(1, ((uint64_t) length_ms * 1000) / this->_tick_us));
+    this->_transition = t;
+    this->step_towards(target, from);
+
+    this->_transition_counters.transitions++;
+    this->_last_tick_us = micros();
+    this->_high_frequency.start();
+    return true;
+  }
+
+  // A control's transition value was not written, as the light is stepping the transition
+  void skip_transition_write() { this->_transition_counters.skipped_writes++; }
+
+  // Write the outputs' frames from the writer's loop, latest frame wins. Expects the outputs to have been added first.
+  void set_async_writer(AsyncFrameWriter *writer) { writer->attach(this->_outputs); }
+
+  // Render on the worker task rather than the loop. Not compatible with layers, and the light stays on the loop if
+  // it has more outputs than the worker takes. Expects the outputs (and their frame sinks) to have been set up first.
+  void set_render_worker(RenderWorker *worker) {
+    if (worker->attach(this, this->_outputs))
+      this->_render_worker = worker;
+  }
+
+  // Called by each control with the values it sets
+  void write_command(XyLightCommand command, XyLightControl *source) {
+    if (this->_transition.has_value()) {
+      if (source != this->_transition->owner) {
+        // Another control's values are taken up by the rest of the stepped transition
+        this->step_towards(command, this->_transition->value);
+        return;
+      }
+      // Values written directly by the control stepped (ie the end of its light state's transition) replace it
+      this->end_transition();
+    }
+
+    if (this->_render_worker) {
+      command.posted_us = micros();
+      this->_render_worker->post(this, command);
+      return;
+    }
+
+    this->execute(command);
+    this->request_apply();
+  }
+
+  // Sets the values of a command without rendering them. Only ever called from the task which renders the light.
+  void execute(const XyLightCommand &command) {
+    if (command.transitioning && !this->_transitioning) {
+      this->_transition_start_frames = this->_render_counters.frames;
+      this->_transition_start_skipped = this->_render_counters.skipped;
+    } else if (!command.transitioning && this->_transitioning && this->_skip_delta_e > 0.0f &&
+               this->_render_counters.frames != this->_transition_start_frames) {
+      // The end of a transition which rendered frames
+      ESP_LOGV("xy_light", "Transition skipped %u of %u frames",
+               (unsigned) (this->_render_counters.skipped - this->_transition_start_skipped),
+               (unsigned) (this->_render_counters.frames - this->_transition_start_frames));
+    }
+    this->_transitioning = command.transitioning;
+
+    if (!std::isnan(command.mired))
+      this->set_color_temperature_value(command.mired);
+    if (!std::isnan(command.saturation))
+      this->set_color_saturation_value(command.saturation);
+    if (!std::isnan(command.brightness))
+      this->set_brightness_value(command.brightness);
+    if (!std::isnan(command.r))
+      this->set_rgb_value(command.r, command.g, command.b);
+  }
+
+  // Called by each control after updating its values
+  void request_apply() {
+    this->_render_counters.requests++;
+    if (!this->_coalesce) {
+      this->render();
+      return;
+    }
+
+    if (this->_frame_pending) {
+      this->_render_counters.coalesced++;
+    }
+    this->_frame_pending = true;
+  }
+
+  void loop() override {
+    if (this->_transition.has_value()) {
+      this->step_transition();
+      return;
+    }
+
+    if (!this->_frame_pending) {
+      if (!this->_render_worker)
+        this->build_luts();
+      return;
+    }
+
+    auto now = millis();
+    if (this->_frame_interval_ms != 0 && now - this->_last_frame_ms < this->_frame_interval_ms) {
+      this->_render_counters.deferred++;
+      return;
+    }
+
+    this->_last_frame_ms = now;
+    this->render();
+  }
+
+  // After the light states, so values written by their loop() are rendered in the same iteration
+  float get_setup_priority() const override { return setup_priority::LATE; }
+
+  void dump_config() override {
+    ESP_LOGCONFIG("xy_light", "XY Light Output:");
+    ESP_LOGCONFIG("xy_light", "  Outputs: %u", (unsigned) this->_outputs.size());
+    if (this->_render_worker) {
+      // The counters belong to the worker, which reports its own
+      ESP_LOGCONFIG("xy_light", "  Rendered on the worker task");
+      return;
+    }
+    if (this->_coalesce) {
+      ESP_LOGCONFIG("xy_light", "  Coalescing: once per loop, frame interval %u ms",
+                    (unsigned) this->_frame_interval_ms);
+    }
+    if (this->_tick_us != 0) {
+      ESP_LOGCONFIG("xy_light", "  Render rate: %.0f Hz", 1000000.0f / (float) this->_tick_us);
+    }
+    if (this->_skip_delta_e > 0.0f) {
+      ESP_LOGCONFIG("xy_light", "  Skipping transition frames within delta E %.2f, %.1f%% skipped", this->_skip_delta_e,
+                    this->_render_counters.skip_ratio() * 100.0f);
+    }
+    ESP_LOGCONFIG("xy_light", "  Frames: %u, coalesced requests: %u, deferred: %u",
+                  (unsigned) this->_render_counters.frames, (unsigned) this->_render_counters.coalesced,
+                  (unsigned) this->_render_counters.deferred);
+  }
+
+  uint8_t add_layer(BlendMode mode, float weight) {
+    this->_output_dirty = true;
+    return this->_compositor.add_layer(mode, weight);
+  }
+
+  bool layered() const { return this->_compositor.size() != 0; }
+
+  // XYZ (white balance and brightness included) and on / off state of a control's layer
+  void set_layer(uint8_t layer, const matrices::Vec3 &XYZ, float state) {
+    this->_compositor.set(layer, XYZ, state);
+    this->_output_dirty = true;
+  }
+
+  // Linear source RGB to XYZ for a layer, white balanced to the given colour temperature (or NAN for none)
+  matrices::Matrix3x3 layer_transform(float mired) {
+    if (std::isnan(mired))
+      return this->_gamut_transform.RGB_2_Cie1931XYZ_transform_matrix();
+
+    auto white_point = color_space::Cct::from_mireds(mired).uv.as_xy_cie1931();
+    return this->_gamut_transform.white_balanced_RGB_2_Cie1931XYZ_transform_matrix(white_point);
+  }
+
+  // Gamma decompressed source RGB
+  color_space::RGB decode_RGB(float r, float g, float b) {
+    XY_PROFILE_STAGE(PROFILE_DECODE);
+    return this->_gamut_transform.RGB_to_linear_RGB(color_space::RGB(r, g, b));
+  }
+
+  const StageCounter &stage_counter(Stage stage) const { return this->_stage_counters[stage]; }
+
+  void reset_stage_counters() {
+    for (auto &counter : this->_stage_counters) {
+      counter = StageCounter();
+    }
+    this->_render_counters = RenderCounters();
+  }
+
+  // Rebuilds the outputs' LUTs for the current white point once it has settled, for at most LUT_BUILD_BUDGET_US at a
+  // time, so no frame waits for a whole table. Outputs evaluate exactly until their table is complete.
+  // Called from the task which renders the light while it is idle.
+  void build_luts() {
+    if (this->_lut_grid_size == 0 || this->_fixed_point || this->layered() || !this->_source_transform.has_value())
+      return;
+    if (millis() - this->_source_changed_ms < LUT_SETTLE_MS)
+      return;
+
+    for (auto output : this->_outputs) {
+      if (!output->build_lut_rows(LUT_BUILD_BUDGET_US))
+        return;
+    }
+  }
+
   void apply() {
-    if (this->_xy.has_value()) {
-      // Use xy values if they have been given
-      this->apply_xyY(this->_xy.value().as_xyY_cie1931(1.0f));
-    } else {
-      // Otherwise convert RGB values to xy from source colour space
-      auto xyY = this->_gamut_transform.RGB_to_XYZ(this->_rgb).as_xyY_cie1931();
-      this->apply_xyY(xyY);
+    if (!this->_output_dirty) {
+      this->_stage_counters[STAGE_OUTPUT].hits++;
+      return;
+    }
+    if (this->skip_frame(this->_transitioning))
+      return;
+
+    this->_stage_counters[STAGE_OUTPUT].misses++;
+    this->_output_dirty = false;
+
+    // Every output calculates its frame before any are committed, so the light changes as a whole
+    for (auto output : this->_outputs) {
+      output->hold_frame();
+    }
+    this->apply_frame();
+    this->commit_frames();
+  }
+
+  void apply_frame() {
+    if (this->layered()) {
+      this->apply_layers();
+      return;
+    }
+
+    if (this->_fixed_point) {
+      this->apply_fixed();
+      return;
+    }
+
+    if (!this->_xy.has_value() && almost_eq(this->_saturation, 1.0f)) {
+      auto &rgb = this->linear_RGB();
+      if (!std::isnan(this->_white_point_mired) && rgb.r == rgb.g && rgb.g == rgb.b) {
+        // A neutral colour balanced to the requested colour temperature (ie CT controls), which lies on the locus
+        this->apply_CT(rgb);
+        return;
+      }
+
+      // Chromaticity is left as is, so outputs can use their fused source to output transform
+      this->apply_linear_RGB(rgb);
+      return;
     }
+
+    this->write_xyY(this->chroma());
   }
 
   void apply_xyY(color_space::xyY_Cie1931 xyY) {
     if (!almost_eq(this->_saturation, 1.0f)) {
+      XY_PROFILE_STAGE(PROFILE_SATURATION);
       xyY = this->_gamut_transform.adjust_saturation(xyY, this->_saturation);
     } 
+    this->write_xyY(xyY);
+  }
 
+  void apply_linear_RGB(color_space::RGB rgb) {
     if (!almost_eq(this->_brightness, 1.0f)) {
-      xyY.Y *= this->_brightness;
+      rgb = rgb.adjust_brightness(this->_brightness);
+    }
+
+    auto &source_transform = this->source_transform();
+    if(this->_calibration_logging) {
+      auto XYZ = source_transform * matrices::Vec3(rgb.r, rgb.g, rgb.b);
+      XyLightOutput::log_calibration_data(color_space::XYZ_Cie1931(XYZ.x, XYZ.y, XYZ.z));
+    }
+
+    for (auto output : this->_outputs){
+        XY_PROFILE_STAGE(PROFILE_OUTPUT_TRANSFORM);
+        output->write_linear_RGB(rgb.r, rgb.g, rgb.b);
+    }
+  }
+
+  void apply_CT(color_space::RGB rgb) {
+    if (!almost_eq(this->_brightness, 1.0f)) {
+      rgb = rgb.adjust_brightness(this->_brightness);
+    }
+
+    // Luminance of the white balanced neutral, without a full mat-vec as r, g and b are equal
+    auto &source_transform = this->source_transform();
+    auto Y = (source_transform(1, 0) + source_transform(1, 1) + source_transform(1, 2)) * rgb.r;
+    if(this->_calibration_logging) {
+      auto XYZ = source_transform * matrices::Vec3(rgb.r, rgb.g, rgb.b);
+      XyLightOutput::log_calibration_data(color_space::XYZ_Cie1931(XYZ.x, XYZ.y, XYZ.z));
+    }
+
+    auto ct = XyCtFrame{this->_white_point_mired, Y};
+    for (auto output : this->_outputs){
+        XY_PROFILE_STAGE(PROFILE_OUTPUT_TRANSFORM);
+        output->set_color_CT(ct, rgb.r, rgb.g, rgb.b);
+    }
+  }
+
+  // One output transform for the blend of every layer
+  void apply_layers() {
+    auto XYZ = this->_compositor.composite();
+
+    if(this->_calibration_logging) {
+      XyLightOutput::log_calibration_data(color_space::XYZ_Cie1931(XYZ.x, XYZ.y, XYZ.z));
+    }
+
+    for (auto output : this->_outputs){
+        XY_PROFILE_STAGE(PROFILE_OUTPUT_TRANSFORM);
+        if (this->_fixed_point) {
+          output->set_color_XYZ_fixed(fixed_point::Vec3::from_float(XYZ.x, XYZ.y, XYZ.z));
+        } else {
+          output->set_color_XYZ(XYZ.x, XYZ.y, XYZ.z);
+        }
+    }
+  }
+
+  // Integer counterpart of apply() for targets without an FPU. Brightness scales XYZ directly,
+  // so the round trip through xyY is only needed when adjusting saturation.
+  void apply_fixed() {
+    auto XYZ = this->chroma_fixed();
+
+    if (!almost_eq(this->_brightness, 1.0f)) {
+      XYZ = XYZ.scale(fixed_point::from_float(this->_brightness));
     }
 
     // Adjust white balance
-    auto XYZ = xyY.as_XYZ_cie1931();
-    XYZ = this->_gamut_transform.adjust_white_balance(XYZ, this->_white_point);
+    XYZ = XYZ * this->white_balance_fixed();
 
     if(this->_calibration_logging) {
-      XyLightOutput::log_calibration_data(XYZ);
+      XyLightOutput::log_calibration_data(color_space::XYZ_Cie1931::from_fixed(XYZ));
     }
-        
+
     for (auto output : this->_outputs){
-        output->set_color_XYZ(XYZ.X, XYZ.Y, XYZ.Z);
+        XY_PROFILE_STAGE(PROFILE_OUTPUT_TRANSFORM);
+        output->set_color_XYZ_fixed(XYZ);
     }
   }
 
   static void log_calibration_data(color_space::XYZ_Cie1931 XYZ) {
+    CalibrationTelemetry::instance()->push(&XyLightOutput::format_calibration_data, {XYZ.X, XYZ.Y, XYZ.Z});
+  }
+
+  static void format_calibration_data(const float *values) {
+    auto XYZ = color_space::XYZ_Cie1931(values[0], values[1], values[2]);
     auto xyY = XYZ.as_xyY_cie1931();
     ESP_LOGI("output.xy_light_output", "xy: [%.3f%%, %.3f%%], XYZ: [%.3f%%, %.3f%%, %.3f%%], Approx Color Temperature: %.0f K", 
       xyY.x, xyY.y, 
       XYZ.X, XYZ.Y, XYZ.Z, 
       xyY.cct_kelvin_approx());
   }
+
+ protected:
+  void render() {
+    this->_frame_pending = false;
+    this->_render_counters.frames++;
+    this->apply();
+  }
+
+  // Whether the light's values are too close to the frame last rendered to be worth rendering. The output stays
+  // dirty when skipped, so the difference is always from what the light is showing.
+  bool skip_frame(bool transitioning) {
+    if (this->_skip_delta_e <= 0.0f || this->layered())
+      return false;
+
+    auto XYZ = this->_fixed_point ? this->light_XYZ_fixed(false) : this->light_XYZ(false);
+    return this->skip_XYZ(XYZ, transitioning);
+  }
+
+  bool skip_XYZ(const color_space::XYZ_Cie1931 &XYZ, bool transitioning) {
+    auto white = this->_gamut_transform.get_white_point().as_xy_cie1931().as_XYZ_cie1931(1.0f);
+    auto Luv = XYZ.as_Luv_cie1976(white);
+    if (transitioning && this->_rendered_Luv.has_value() &&
+        Luv.delta_e_squared(this->_rendered_Luv.value()) < this->_skip_delta_e * this->_skip_delta_e) {
+      this->_render_counters.skipped++;
+      return true;
+    }
+
+    this->_rendered_Luv = Luv;
+    return false;
+  }
+
+  // The light's values as the endpoint of a stepped transition, on the path apply_frame() renders them with
+  XyTransitionPoint transition_point() {
+    XyTransitionPoint p;
+    color_space::XYZ_Cie1931 XYZ;
+    color_space::RGB rgb;
+    if (this->_fixed_point) {
+      XYZ = this->light_XYZ_fixed();
+      // Written as XYZ, but still stepped along the locus
+      if (!this->_xy.has_value() && almost_eq(this->_saturation, 1.0f) && !std::isnan(this->_white_point_mired) &&
+          this->_rgb.r == this->_rgb.g && this->_rgb.g == this->_rgb.b) {
+        p.path = TICK_CT;
+        p.mired = this->_white_point_mired;
+      }
+    } else {
+      XYZ = this->light_XYZ();
+      if (!this->_xy.has_value() && almost_eq(this->_saturation, 1.0f)) {
+        rgb = this->linear_RGB().adjust_brightness(this->_brightness);
+        if (!std::isnan(this->_white_point_mired) && rgb.r == rgb.g && rgb.g == rgb.b) {
+          p.path = TICK_CT;
+          p.mired = this->_white_point_mired;
+        } else {
+          p.path = TICK_LINEAR_RGB;
+        }
+      }
+    }
+
+    // Black has no chromaticity, so is given the other endpoint's
+    if (XYZ.Y > 0.0f) {
+      p.chroma = matrices::Vec3(XYZ.X / XYZ.Y, 1.0f, XYZ.Z / XYZ.Y);
+      p.rgb = matrices::Vec3(rgb.r / XYZ.Y, rgb.g / XYZ.Y, rgb.b / XYZ.Y);
+      p.lightness = this->_lightness_compress(XYZ.Y);
+    }
+    return p;
+  }
+
+  // Sets the values of a command on the light, and steps the current transition from a point towards them over the
+  // ticks it has left
+  void step_towards(XyLightCommand command, XyTransitionPoint from) {
+    auto white_point = this->_white_point.as_xy_cie1931();
+    command.transitioning = true;
+    this->execute(command);
+    auto to = this->transition_point();
+
+    if (from.lightness <= 0.0f) {
+      from = to;
+      from.lightness = 0.0f;
+    } else if (to.lightness <= 0.0f) {
+      to = from;
+      to.lightness = 0.0f;
+    }
+    auto new_white_point = this->_white_point.as_xy_cie1931();
+    if (from.path != to.path ||
+        (to.path == TICK_LINEAR_RGB && (new_white_point.x != white_point.x || new_white_point.y != white_point.y))) {
+      from.path = to.path = TICK_XYZ;
+    }
+    if (to.path == TICK_LINEAR_RGB) {
+      // Pushed to the outputs for the linear RGB they are written with
+      this->source_transform();
+    }
+
+    auto &t = this->_transition.value();
+    auto n = (float) t.ticks_left;
+    t.value = from;
+    t.step.chroma = matrices::Vec3((to.chroma.x - from.chroma.x) / n, 0.0f, (to.chroma.z - from.chroma.z) / n);
+    t.step.rgb = matrices::Vec3((to.rgb.x - from.rgb.x) / n, (to.rgb.y - from.rgb.y) / n, (to.rgb.z - from.rgb.z) / n);
+    t.step.mired = (to.mired - from.mired) / n;
+    t.step.lightness = (to.lightness - from.lightness) / n;
+  }
+
+  // White balanced XYZ of the light's values, as apply() would render them. The source transform is not built, as
+  // that is pushed to the outputs. Uncounted (ie to decide whether to render at all), stages which are not cached
+  // are calculated without being stored, so the stage counters only reflect rendering.
+  color_space::XYZ_Cie1931 light_XYZ(bool counted = true) {
+    color_space::XYZ_Cie1931 XYZ;
+    if (!this->_xy.has_value() && almost_eq(this->_saturation, 1.0f)) {
+      auto rgb = counted ? this->linear_RGB() : this->peek_linear_RGB();
+      if (!almost_eq(this->_brightness, 1.0f)) {
+        rgb = rgb.adjust_brightness(this->_brightness);
+      }
+      auto v = this->_gamut_transform.RGB_2_Cie1931XYZ_transform_matrix() * matrices::Vec3(rgb.r, rgb.g, rgb.b);
+      XYZ = color_space::XYZ_Cie1931(v.x, v.y, v.z);
+    } else {
+      auto xyY = counted ? this->chroma() : this->peek_chroma();
+      xyY.Y *= this->_brightness;
+      XYZ = xyY.as_XYZ_cie1931();
+    }
+    auto white_balance = counted ? this->white_balance() : this->peek_white_balance();
+    return color_space::XYZ_Cie1931(XYZ.X * white_balance.x, XYZ.Y * white_balance.y, XYZ.Z * white_balance.z);
+  }
+
+  // As apply_fixed() renders them
+  color_space::XYZ_Cie1931 light_XYZ_fixed(bool counted = true) {
+    auto XYZ = counted ? this->chroma_fixed() : this->peek_chroma_fixed();
+    if (!almost_eq(this->_brightness, 1.0f)) {
+      XYZ = XYZ.scale(fixed_point::from_float(this->_brightness));
+    }
+    return color_space::XYZ_Cie1931::from_fixed(XYZ * (counted ? this->white_balance_fixed()
+                                                               : this->peek_white_balance_fixed()));
+  }
+
+  void step_transition() {
+    auto now = micros();
+    auto interval = now - this->_last_tick_us;
+    if (interval < this->_tick_us)
+      return;
+    this->_last_tick_us = now;
+
+    auto &c = this->_transition_counters;
+    auto jitter = interval - this->_tick_us;
+    c.ticks++;
+    c.total_jitter_us += jitter;
+    if (jitter > c.max_jitter_us)
+      c.max_jitter_us = jitter;
+
+    auto &t = this->_transition.value();
+    if (--t.ticks_left == 0) {
+      this->end_transition();
+    } else {
+      this->render_tick(t);
+    }
+
+    auto cost = micros() - now;
+    c.total_cost_us += cost;
+    if (cost > c.max_cost_us)
+      c.max_cost_us = cost;
+  }
+
+  void render_tick(XyTransition &t) {
+    auto &value = t.value;
+    auto &step = t.step;
+    value.lightness += step.lightness;
+    if (value.path == TICK_CT) {
+      // Along the locus rather than the chord between the endpoints
+      value.mired += step.mired;
+      auto xy = color_space::Cct::from_mireds(value.mired).uv.as_xy_cie1931();
+      value.chroma = matrices::Vec3(xy.x / xy.y, 1.0f, (1.0f - xy.x - xy.y) / xy.y);
+    } else {
+      value.chroma.x += step.chroma.x;
+      value.chroma.z += step.chroma.z;
+      value.rgb = matrices::Vec3(value.rgb.x + step.rgb.x, value.rgb.y + step.rgb.y, value.rgb.z + step.rgb.z);
+    }
+
+    auto Y = this->_lightness_decompress(std::max(value.lightness, 0.0f));
+    auto XYZ = color_space::XYZ_Cie1931(value.chroma.x * Y, Y, value.chroma.z * Y);
+
+    // The outputs no longer show the light's values, which are the transition's target
+    this->_output_dirty = true;
+    this->_render_counters.frames++;
+    if (this->_skip_delta_e > 0.0f && this->skip_XYZ(XYZ, true))
+      return;
+
+    if(this->_calibration_logging) {
+      XyLightOutput::log_calibration_data(XYZ);
+    }
+
+    for (auto output : this->_outputs) {
+      output->hold_frame();
+    }
+    for (auto output : this->_outputs) {
+      XY_PROFILE_STAGE(PROFILE_OUTPUT_TRANSFORM);
+      if (this->_fixed_point) {
+        output->set_color_XYZ_fixed(fixed_point::Vec3::from_float(XYZ.X, XYZ.Y, XYZ.Z));
+      } else if (value.path == TICK_LINEAR_RGB) {
+        output->write_linear_RGB(value.rgb.x * Y, value.rgb.y * Y, value.rgb.z * Y);
+      } else if (value.path == TICK_CT) {
+        output->set_color_CT_XYZ(XyCtFrame{value.mired, Y}, XYZ.X, XYZ.Y, XYZ.Z);
+      } else {
+        output->set_color_XYZ(XYZ.X, XYZ.Y, XYZ.Z);
+      }
+    }
+    this->commit_frames();
+  }
+
+  // The final frame is rendered exactly from the light's values, which the transition was stepped towards
+  void end_transition() {
+    this->_transition.reset();
+    this->_high_frequency.stop();
+    // Ends the transition for the skip counters
+    this->execute(XyLightCommand());
+    this->_output_dirty = true;
+    this->render();
+
+    auto &c = this->_transition_counters;
+    if (c.ticks != 0) {
+      ESP_LOGV("xy_light", "Stepped %u ticks, jitter %.0f us mean / %u us max, cost %.0f us mean / %u us max",
+               (unsigned) c.ticks, (float) c.total_jitter_us / (float) c.ticks, (unsigned) c.max_jitter_us,
+               (float) c.total_cost_us / (float) c.ticks, (unsigned) c.max_cost_us);
+    }
+  }
+
+  void commit_frames() {
+    for (auto output : this->_outputs) {
+      output->release_frame();
+    }
+
+    // Then latch each sink once, as outputs may share one (ie channels on the same PWM chip)
+    for (size_t i = 0; i < this->_outputs.size(); i++) {
+      auto *sink = this->_outputs[i]->get_frame_sink();
+      size_t j = 0;
+      while (j < i && this->_outputs[j]->get_frame_sink() != sink)
+        j++;
+      if (j == i)
+        sink->latch();
+    }
+  }
+
+  void reset_source() {
+    this->_linear_rgb.reset();
+    this->_chroma.reset();
+    this->_XYZ_fixed.reset();
+    this->_chroma_fixed.reset();
+    this->_output_dirty = true;
+  }
+
+  void reset_white_balance() {
+    this->_white_point_mired = NAN;
+    this->_white_balance.reset();
+    this->_white_balance_fixed.reset();
+    this->_source_transform.reset();
+    this->_output_dirty = true;
+  }
+
+  // Brightness, white balance and output transforms, applied to an already saturated chromaticity
+  void write_xyY(color_space::xyY_Cie1931 xyY) {
+    if (!almost_eq(this->_brightness, 1.0f)) {
+      xyY.Y *= this->_brightness;
+    }
+
+    // Adjust white balance
+    auto XYZ = xyY.as_XYZ_cie1931();
+    auto &white_balance = this->white_balance();
+    XYZ.X *= white_balance.x;
+    XYZ.Y *= white_balance.y;
+    XYZ.Z *= white_balance.z;
+
+    if(this->_calibration_logging) {
+      XyLightOutput::log_calibration_data(XYZ);
+    }
+        
+    for (auto output : this->_outputs){
+        XY_PROFILE_STAGE(PROFILE_OUTPUT_TRANSFORM);
+        output->set_color_XYZ(XYZ.X, XYZ.Y, XYZ.Z);
+    }
+  }
+
+  bool count_stage(Stage stage, bool hit) {
+    if (hit) {
+      this->_stage_counters[stage].hits++;
+    } else {
+      this->_stage_counters[stage].misses++;
+    }
+    return hit;
+  }
+
+  color_space::RGB &linear_RGB() {
+    if (!this->count_stage(STAGE_DECODE, this->_linear_rgb.has_value())) {
+      XY_PROFILE_STAGE(PROFILE_DECODE);
+      this->_linear_rgb = this->_gamut_transform.RGB_to_linear_RGB(this->_rgb);
+    }
+    return this->_linear_rgb.value();
+  }
+
+  color_space::xyY_Cie1931 &chroma() {
+    if (!this->count_stage(STAGE_SATURATION, this->_chroma.has_value())) {
+      XY_PROFILE_STAGE(PROFILE_SATURATION);
+      // Use xy values if they have been given, otherwise convert RGB values to xy from source colour space
+      this->_chroma = this->_xy.has_value() ? this->saturated_chroma(this->_xy.value().as_xyY_cie1931(1.0f))
+                                            : this->saturated_chroma(this->linear_RGB());
+    }
+    return this->_chroma.value();
+  }
+
+  color_space::xyY_Cie1931 saturated_chroma(const color_space::RGB &linear_rgb) {
+    auto XYZ = this->_gamut_transform.RGB_2_Cie1931XYZ_transform_matrix() *
+               matrices::Vec3(linear_rgb.r, linear_rgb.g, linear_rgb.b);
+    return this->saturated_chroma(color_space::XYZ_Cie1931(XYZ.x, XYZ.y, XYZ.z).as_xyY_cie1931());
+  }
+
+  color_space::xyY_Cie1931 saturated_chroma(color_space::xyY_Cie1931 xyY) {
+    if (!almost_eq(this->_saturation, 1.0f)) {
+      xyY = this->_gamut_transform.adjust_saturation(xyY, this->_saturation);
+    }
+    return xyY;
+  }
+
+  fixed_point::Vec3 &XYZ_fixed() {
+    if (!this->count_stage(STAGE_DECODE, this->_XYZ_fixed.has_value())) {
+      XY_PROFILE_STAGE(PROFILE_DECODE);
+      this->_XYZ_fixed = this->source_XYZ_fixed();
+    }
+    return this->_XYZ_fixed.value();
+  }
+
+  fixed_point::Vec3 source_XYZ_fixed() {
+    if (this->_xy.has_value()) {
+      auto xy = this->_xy.value();
+      return fixed_point::xyY_to_XYZ(fixed_point::Vec3::from_float(xy.x, xy.y, 1.0f));
+    }
+    return this->_gamut_transform.RGB_to_XYZ_fixed(this->_rgb);
+  }
+
+  fixed_point::Vec3 &chroma_fixed() {
+    if (!this->count_stage(STAGE_SATURATION, this->_chroma_fixed.has_value())) {
+      XY_PROFILE_STAGE(PROFILE_SATURATION);
+      this->_chroma_fixed = this->saturated_chroma_fixed(this->XYZ_fixed());
+    }
+    return this->_chroma_fixed.value();
+  }
+
+  fixed_point::Vec3 saturated_chroma_fixed(fixed_point::Vec3 XYZ) {
+    if (!almost_eq(this->_saturation, 1.0f)) {
+      auto xyY = this->_gamut_transform.adjust_saturation(fixed_point::XYZ_to_xyY(XYZ),
+                                                          fixed_point::from_float(this->_saturation));
+      XYZ = fixed_point::xyY_to_XYZ(xyY);
+    }
+    return XYZ;
+  }
+
+  // Each stage's value without going through its cache, so nothing is stored or counted. Cached values are used
+  // when they are up to date.
+  color_space::RGB peek_linear_RGB() {
+    if (this->_linear_rgb.has_value())
+      return this->_linear_rgb.value();
+    return this->_gamut_transform.RGB_to_linear_RGB(this->_rgb);
+  }
+
+  color_space::xyY_Cie1931 peek_chroma() {
+    if (this->_chroma.has_value())
+      return this->_chroma.value();
+    return this->_xy.has_value() ? this->saturated_chroma(this->_xy.value().as_xyY_cie1931(1.0f))
+                                 : this->saturated_chroma(this->peek_linear_RGB());
+  }
+
+  fixed_point::Vec3 peek_chroma_fixed() {
+    if (this->_chroma_fixed.has_value())
+      return this->_chroma_fixed.value();
+    return this->saturated_chroma_fixed(this->_XYZ_fixed.has_value() ? this->_XYZ_fixed.value()
+                                                                     : this->source_XYZ_fixed());
+  }
+
+  matrices::Vec3 peek_white_balance() {
+    if (this->_white_balance.has_value())
+      return this->_white_balance.value();
+    return this->_gamut_transform.white_balance_scale(this->_white_point);
+  }
+
+  fixed_point::Vec3 peek_white_balance_fixed() {
+    if (this->_white_balance_fixed.has_value())
+      return this->_white_balance_fixed.value();
+    return fixed_point::Vec3::from_float(this->peek_white_balance());
+  }
+
+  // Source RGB to white balanced XYZ, pushed to the outputs whenever it changes
+  matrices::Matrix3x3 &source_transform() {
+    if (!this->count_stage(STAGE_WHITE_BALANCE, this->_source_transform.has_value())) {
+      XY_PROFILE_STAGE(PROFILE_WHITE_BALANCE);
+      this->_source_transform =
+          this->_gamut_transform.white_balanced_RGB_2_Cie1931XYZ_transform_matrix(this->_white_point);
+      for (auto output : this->_outputs) {
+        output->set_source_transform(this->_source_transform.value());
+      }
+      this->_source_changed_ms = millis();
+    }
+    return this->_source_transform.value();
+  }
+
+  matrices::Vec3 &white_balance() {
+    if (!this->count_stage(STAGE_WHITE_BALANCE, this->_white_balance.has_value())) {
+      XY_PROFILE_STAGE(PROFILE_WHITE_BALANCE);
+      this->_white_balance = this->_gamut_transform.white_balance_scale(this->_white_point);
+    }
+    return this->_white_balance.value();
+  }
+
+  fixed_point::Vec3 &white_balance_fixed() {
+    if (!this->count_stage(STAGE_WHITE_BALANCE, this->_white_balance_fixed.has_value())) {
+      XY_PROFILE_STAGE(PROFILE_WHITE_BALANCE);
+      this->_white_balance_fixed = fixed_point::Vec3::from_float(this->white_balance());
+    }
+    return this->_white_balance_fixed.value();
+  }
 };
 
 enum class ControlAttributes : std::uint8_t {
@@ -168,6 +1110,67 @@ class XyLightControl : public light::LightOutput, public Component  {
 
   XyLightOutput* _xy_output_light;
 
+  // Brightness gamma is owned by the light state, so the table is built on first use (or if it changes)
+  float _gamma_correct = NAN;
+  color_space::TransferFunction _brightness_decompress;
+
+  // Index of this control's layer, when the light blends its controls rather than sharing one colour
+  int16_t _layer = -1;
+  // Source RGB to XYZ of the layer, for the colour temperature it was last white balanced to
+  float _layer_mired = NAN;
+  optional<matrices::Matrix3x3> _layer_transform = {};
+
+  // Set while the light is stepping this control's transition, so the values interpolated by the light state are
+  // not written
+  bool _transition_owned = false;
+
+  XyLightCommand make_command(const light::LightColorValues &values, float intensity) {
+    XyLightCommand command;
+    if ((uint8_t)(this->_control_attributes & (ControlAttributes::CT | ControlAttributes::CW_WW))) {
+        command.mired = values.get_color_temperature();
+    }
+  
+    if ((uint8_t)(this->_control_attributes & ControlAttributes::SATURATION)) {
+        command.saturation = intensity;
+    } else {
+        command.brightness = intensity;
+    }
+
+    if ((uint8_t)(this->_control_attributes & ControlAttributes::RGB)) {
+        // be careful not to decompress gamma here, as this will be done by the profile
+        command.r = values.get_red();
+        command.g = values.get_green();
+        command.b = values.get_blue();
+    }
+
+    // Not supported by esphome at this time
+    //if (this->_control_attributes & ControlAttributes::XY) {
+        // command.x, command.y = ...
+    //}
+    return command;
+  }
+
+  void write_layer(const light::LightColorValues &values, float intensity) {
+    float mired = NAN;
+    if ((uint8_t)(this->_control_attributes & (ControlAttributes::CT | ControlAttributes::CW_WW))) {
+      mired = values.get_color_temperature();
+    }
+
+    if (!this->_layer_transform.has_value() || (mired != this->_layer_mired && !std::isnan(mired))) {
+      this->_layer_transform = this->_xy_output_light->layer_transform(mired);
+      this->_layer_mired = mired;
+    }
+
+    auto rgb = color_space::RGB(1.0f, 1.0f, 1.0f);
+    if ((uint8_t)(this->_control_attributes & ControlAttributes::RGB)) {
+      rgb = this->_xy_output_light->decode_RGB(values.get_red(), values.get_green(), values.get_blue());
+    }
+
+    auto XYZ = this->_layer_transform.value() * matrices::Vec3(rgb.r * intensity, rgb.g * intensity, rgb.b * intensity);
+    this->_xy_output_light->set_layer((uint8_t) this->_layer, XYZ, values.get_state());
+    this->_xy_output_light->request_apply();
+  }
+
   public:
   void set_color_temperature_range(float min_mired, float max_mired) {
     this->_traits.set_min_mireds(min_mired);
@@ -206,46 +1209,90 @@ class XyLightControl : public light::LightOutput, public Component  {
     this->_xy_output_light = _xy_output_light;
   }
 
+  // Blend this control into the light as its own layer. Expects set_xy_light_output() to have been called.
+  void set_layer(BlendMode mode, float weight) {
+    this->_layer = this->_xy_output_light->add_layer(mode, weight);
+  }
+
   light::LightTraits get_traits() override {
     return this->_traits;
   }
 
   void write_state(light::LightState *state) override {
+    if (this->_transition_owned) {
+      if (state->is_transformer_active()) {
+        this->_xy_output_light->skip_transition_write();
+        return;
+      }
+      this->_transition_owned = false;
+    }
+    this->write_color_values(state->current_values, state->get_gamma_correct(), state->is_transformer_active());
+  }
+
+  // Drives the light from colour values directly, ie without a LightState when simulating. Values written while
+  // transitioning may be skipped by the light if they are too close to its last frame to see.
+  void write_color_values(const light::LightColorValues &values, float gamma_correct, bool transitioning = false) {
     if(!this->_xy_output_light)
        return;
 
-    if ((uint8_t)(this->_control_attributes & (ControlAttributes::CT | ControlAttributes::CW_WW))) {
-        auto ct = state->current_values.get_color_temperature();
-        this->_xy_output_light->set_color_temperature_value(ct);
+    auto *trace = this->_xy_output_light->get_command_trace();
+    if (trace) {
+      trace->record((uint8_t) this->_control_attributes, values.get_state(), values.get_brightness(),
+                    values.get_red(), values.get_green(), values.get_blue(), values.get_color_temperature(),
+                    gamma_correct);
     }
 
-    auto corrected_brightness = color_space::exp_gamma_decompress(state->current_values.get_brightness(), state->get_gamma_correct());
-    auto intensity = state->current_values.get_state() * corrected_brightness;
-  
-    if ((uint8_t)(this->_control_attributes & ControlAttributes::SATURATION)) {
-        this->_xy_output_light->set_color_saturation_value(intensity);
-    } else {
-        this->_xy_output_light->set_brightness_value(intensity);
+    if (gamma_correct != this->_gamma_correct) {
+      this->_gamma_correct = gamma_correct;
+      this->_brightness_decompress = color_space::TransferFunction::exp_gamma_decompress(gamma_correct);
     }
 
-    if ((uint8_t)(this->_control_attributes & ControlAttributes::RGB)) {
-        // be careful not to decompress gamma here, as this will be done by the profile
-        this->_xy_output_light->set_rgb_value(
-            state->current_values.get_red(),
-            state->current_values.get_green(),
-            state->current_values.get_blue()
-        );
+    auto corrected_brightness = this->_brightness_decompress(values.get_brightness());
+    auto intensity = values.get_state() * corrected_brightness;
+
+    if (this->_layer >= 0) {
+      // Saturation controls set the brightness of their own layer
+      this->write_layer(values, intensity);
+      return;
     }
 
-    // Not supported by esphome at this time
-    //if (this->_control_attributes & ControlAttributes::XY) {
-        // this->_xy_output_light->set_xy_value(...);
-    //}
+    auto command = this->make_command(values, intensity);
+    command.transitioning = transitioning;
+    this->_xy_output_light->write_command(command, this);
+  }
 
-    this->_xy_output_light->apply();
+  // Called as the light state starts a transition. If the light can step it, the values the light state
+  // interpolates are skipped until it ends.
+  void begin_transition(const light::LightColorValues &target, uint32_t length_ms) {
+    if (!this->_xy_output_light || std::isnan(this->_gamma_correct) || this->_layer >= 0)
+      return;
+
+    auto intensity = target.get_state() * this->_brightness_decompress(target.get_brightness());
+    this->_transition_owned =
+        this->_xy_output_light->begin_transition(this->make_command(target, intensity), length_ms, this->_gamma_correct,
+                                                 this);
+  }
+
+  std::unique_ptr<light::LightTransformer> create_default_transition() override;
+};
+
+// The light state's usual transition, which also hands the transition to the light to step at its render rate
+class XyLightTransformer : public light::LightTransitionTransformer {
+ public:
+  explicit XyLightTransformer(XyLightControl *control) : _control(control) {}
+
+  void start() override {
+    light::LightTransitionTransformer::start();
+    this->_control->begin_transition(this->get_target_values(), this->length_);
   }
+
+ protected:
+  XyLightControl *_control;
 };
 
+inline std::unique_ptr<light::LightTransformer> XyLightControl::create_default_transition() {
+  return std::unique_ptr<light::LightTransformer>(new XyLightTransformer(this));
+}
 
 }  // namespace xy_light
 }  // namespace esphome
@@ -0,0 +1,103 @@
+#include <algorithm>
+
+#include "esphome/core/hal.h"
+#include "esphome/components/xy_light/xy_output.h"
+
+using namespace esphome::xy_light;
+
+void XyOutput::evaluate_linear_RGB(float r, float g, float b, float *levels) {
+  for (size_t i = 0; i < this->_lut_channels.size(); i++) {
+    levels[i] = 0.0f;
+  }
+
+  this->_capture = levels;
+  this->set_color_linear_RGB(r, g, b);
+  this->_capture = nullptr;
+}
+
+bool XyOutput::build_lut_rows(uint32_t budget_us) {
+  if (this->_lut_grid_size == 0 || this->_lut_valid)
+    return true;
+
+  if (!this->_lut.has_value()) {
+    // Allocated once, and rebuilt in place whenever the source transform changes
+    this->_lut_channels = this->channels();
+    if (this->_lut_channels.size() > Lut3d::MAX_CHANNELS)
+      this->_lut_channels.resize(Lut3d::MAX_CHANNELS);
+    this->_lut = Lut3d(this->_lut_grid_size, this->_lut_channels.size());
+    this->_lut_next_row = 0;
+  }
+
+  auto &lut = this->_lut.value();
+  auto grid_size = lut.grid_size();
+  auto rows = (size_t) grid_size * grid_size;
+  float levels[Lut3d::MAX_CHANNELS];
+  auto start = micros();
+  do {
+    auto r = this->_lut_next_row / grid_size;
+    auto g = this->_lut_next_row % grid_size;
+    for (size_t b = 0; b < grid_size; b++) {
+      this->evaluate_linear_RGB(lut.grid_value(r), lut.grid_value(g), lut.grid_value(b), levels);
+      lut.set(r, g, b, levels);
+    }
+    this->_lut_next_row++;
+  } while (this->_lut_next_row < rows && micros() - start < budget_us);
+
+  this->_lut_valid = this->_lut_next_row == rows;
+  return this->_lut_valid;
+}
+
+void XyOutput::build_lut() {
+  while (!this->build_lut_rows(UINT32_MAX)) {
+  }
+}
+
+Lut3dReport XyOutput::lut_report() {
+  Lut3dReport report{0, 0.0f, 0.0f};
+  if (this->_lut_grid_size == 0)
+    return report;
+
+  this->build_lut();
+
+  auto &lut = this->_lut.value();
+  report.memory_usage = lut.memory_usage();
+
+  float exact[Lut3d::MAX_CHANNELS];
+  float approx[Lut3d::MAX_CHANNELS];
+
+  // CIELAB is relative to the output's own white, ie the mix at full source RGB
+  this->evaluate_linear_RGB(1.0f, 1.0f, 1.0f, exact);
+  auto white = this->levels_to_XYZ(exact);
+  bool has_XYZ = white.has_value() && white->X > 0.0f && white->Y > 0.0f && white->Z > 0.0f;
+
+  // Sample at the centre of each cell, in the same encoding the grid is spaced in, as that is furthest from the
+  // points the table was built from
+  size_t cells = lut.grid_size() - 1;
+  auto centre = [&](size_t i) {
+    return color_space::exp_gamma_decompress(((float) i + 0.5f) / (float) cells, Lut3d::ENCODING_GAMMA);
+  };
+  for (size_t ri = 0; ri < cells; ri++) {
+    for (size_t gi = 0; gi < cells; gi++) {
+      for (size_t bi = 0; bi < cells; bi++) {
+        auto r = centre(ri), g = centre(gi), b = centre(bi);
+
+        this->evaluate_linear_RGB(r, g, b, exact);
+        lut.lookup(r, g, b, approx);
+
+        for (uint8_t c = 0; c < lut.channels(); c++) {
+          report.max_level_error = std::max(report.max_level_error, fabsf(exact[c] - approx[c]));
+        }
+
+        if (has_XYZ) {
+          auto delta_e = this->levels_to_XYZ(exact)->delta_e(*this->levels_to_XYZ(approx), *white);
+          report.max_delta_e = std::max(report.max_delta_e, delta_e);
+        }
+      }
+    }
+  }
+
+  if (!has_XYZ)
+    report.max_delta_e = NAN;
+
+  return report;
+}
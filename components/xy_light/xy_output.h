@@ -1,12 +1,288 @@
 #pragma once
+#include <math.h>
+#include <stdint.h>
+#include <vector>
+#include "esphome/core/optional.h"
+#include "esphome/components/output/float_output.h"
+#include "esphome/components/xy_light/color_spaces.h"
+#include "esphome/components/xy_light/fixed_point.h"
+#include "esphome/components/xy_light/lut3d.h"
+#include "esphome/components/xy_light/matrices.h"
+#include "esphome/components/xy_light/profiling.h"
 
 namespace esphome {
 namespace xy_light {
 
+// A single hardware channel. Remembers the duty code it was last written with, so that levels which round to the
+// same code at the output's bit depth are not written again (each write is an I2C transaction on a PCA9685 etc)
+struct XyChannel {
+  const char *name;
+  output::FloatOutput *output = nullptr;
+  int32_t last_duty = -1;
+  uint32_t writes = 0;
+  uint32_t suppressed_writes = 0;
+
+  XyChannel(const char *name) : name(name) {}
+};
+
+// The channel levels of one output which changed in a frame, committed to the hardware together
+struct XyFrame {
+  static const uint8_t MAX_CHANNELS = 5;
+
+  struct Level {
+    const XyChannel *channel;
+    float level;
+    // Level rounded to the output's bit depth
+    uint32_t duty;
+  };
+
+  Level levels[MAX_CHANNELS];
+  uint8_t size = 0;
+  uint8_t bit_depth = 16;
+
+  void add(const XyChannel &channel, float level, uint32_t duty) {
+    if (this->size < MAX_CHANNELS)
+      this->levels[this->size++] = {&channel, level, duty};
+  }
+
+  // Folds a later frame of the same output into this one, its levels replacing those of the same channel
+  void merge(const XyFrame &other) {
+    for (uint8_t i = 0; i < other.size; i++) {
+      auto &level = other.levels[i];
+      uint8_t j = 0;
+      while (j < this->size && this->levels[j].channel != level.channel)
+        j++;
+      if (j < this->size) {
+        this->levels[j] = level;
+      } else {
+        this->add(*level.channel, level.level, level.duty);
+      }
+    }
+    this->bit_depth = other.bit_depth;
+  }
+
+  void clear() { this->size = 0; }
+};
+
+// Receives an output's frames. Drivers for bus attached PWM chips can implement this to write all the channels of
+// a frame in a single burst (ie one auto incrementing I2C write, or one SPI frame), rather than one per channel.
+class XyFrameSink {
+ public:
+  virtual void commit_frame(const XyFrame &frame) = 0;
+
+  // Called once every output of a light has committed its frame for a render. Sinks which can update their
+  // channels synchronously (ie buffer in commit_frame() and write everything here) make the whole light change at once.
+  virtual void latch() {}
+};
+
+// Default sink, which writes each channel through its FloatOutput
+class FloatOutputFrameSink : public XyFrameSink {
+ public:
+  void commit_frame(const XyFrame &frame) override {
+    for (uint8_t i = 0; i < frame.size; i++) {
+      frame.levels[i].channel->output->set_level(frame.levels[i].level);
+    }
+  }
+
+  static FloatOutputFrameSink *instance() {
+    static FloatOutputFrameSink sink;
+    return &sink;
+  }
+};
+
+// A neutral source colour while the light's white point is set from a colour temperature,
+// ie a point on the planckian locus with luminance Y (white balance included)
+struct XyCtFrame {
+  float mired;
+  float Y;
+};
+
+// Size and accuracy of an output's 3D LUT, measured against the exact pipeline
+struct Lut3dReport {
+  size_t memory_usage;
+  // CIE76, of the light mixed from the channels (or NAN when the output does not describe its channels)
+  float max_delta_e;
+  float max_level_error;
+};
+
 class XyOutput {
+ protected:
+  // Resolution of the underlying outputs, the fixed point pipeline rounds to a whole duty code at this depth
+  uint8_t _bit_depth = 16;
+  uint32_t _max_duty = 65535;
+  float _duty_scale = 1.0f / 65535.0f;
+
+  // Source linear RGB to white balanced XYZ, kept up to date by the light
+  matrices::Matrix3x3 _source_transform = matrices::Matrix3x3(1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
+
+  XyFrameSink *_frame_sink = FloatOutputFrameSink::instance();
+  XyFrame _frame;
+  // While held, the frame is kept once calculated, and committed by release_frame()
+  bool _frame_held = false;
+
+  // Optional 3D LUT from linear source RGB to channel levels. Only used once it has been built for the current
+  // source transform (ie the light's white point). Until then, including while the white point is changing, levels
+  // are evaluated exactly, and the light rebuilds the table a few rows at a time with build_lut_rows().
+  uint8_t _lut_grid_size = 0;
+  optional<Lut3d> _lut = {};
+  bool _lut_valid = false;
+  // Next row of the grid to build, as r * grid_size + g
+  size_t _lut_next_row = 0;
+  std::vector<XyChannel *> _lut_channels;
+
+  // While evaluating the exact pipeline for the LUT, levels are captured here rather than written
+  float *_capture = nullptr;
+
+  bool capturing() const { return this->_capture != nullptr; }
+
+  void capture_level(const XyChannel &channel, float level) {
+    for (size_t i = 0; i < this->_lut_channels.size(); i++) {
+      if (this->_lut_channels[i] == &channel)
+        this->_capture[i] = level;
+    }
+  }
+
+  // Levels of the exact pipeline for the given linear source RGB, in _lut_channels order
+  void evaluate_linear_RGB(float r, float g, float b, float *levels);
+
+  // Builds the whole table at once, ie for lut_report()
+  void build_lut();
+
+  // Levels are added to the current frame, and written by commit_frame() once all channels have been calculated
+  void write_level(XyChannel &channel, fixed_point::fixed_t level) {
+    if (this->capturing()) {
+      this->capture_level(channel, fixed_point::to_float(fixed_point::clamp_unit(level)));
+      return;
+    }
+
+    auto duty = fixed_point::to_duty(level, this->_bit_depth);
+    if (this->commit_duty(channel, duty))
+      this->_frame.add(channel, (float) duty * this->_duty_scale, duty);
+  }
+
+  // Level is expected to be clamped to [0, 1] already, and is written as is if its duty code changed
+  void write_level(XyChannel &channel, float level) {
+    if (this->capturing()) {
+      this->capture_level(channel, level);
+      return;
+    }
+
+    auto duty = (uint32_t) lroundf(level * (float) this->_max_duty);
+    if (this->commit_duty(channel, duty))
+      this->_frame.add(channel, level, duty);
+  }
+
+  void commit_frame() {
+    if (this->_frame.size == 0 || this->capturing() || this->_frame_held)
+      return;
+
+    XY_PROFILE_STAGE(PROFILE_COMMIT);
+    this->_frame.bit_depth = this->_bit_depth;
+    this->_frame_sink->commit_frame(this->_frame);
+    this->_frame.clear();
+  }
+
+  bool commit_duty(XyChannel &channel, uint32_t duty) {
+    if (!channel.output)
+      return false;
+
+    if ((int32_t) duty == channel.last_duty) {
+      channel.suppressed_writes++;
+      return false;
+    }
+
+    channel.last_duty = (int32_t) duty;
+    channel.writes++;
+    return true;
+  }
+
  public:
+  virtual ~XyOutput() = default;
+
   virtual void set_color_XYZ(float X, float Y, float Z) = 0;
+
+  // Fixed point pipeline, outputs without an integer path fall back to the float one
+  virtual void set_color_XYZ_fixed(const fixed_point::Vec3 &XYZ) {
+    this->set_color_XYZ(fixed_point::to_float(XYZ.x), fixed_point::to_float(XYZ.y), fixed_point::to_float(XYZ.z));
+  }
+
+  // Called by the light whenever its source profile or white point changes.
+  // Outputs can override this to precompose the transform with their own.
+  virtual void set_source_transform(const matrices::Matrix3x3 &source_transform) {
+    this->_source_transform = source_transform;
+    this->_lut_valid = false;
+    this->_lut_next_row = 0;
+  }
+
+  // Gamma decompressed source RGB with brightness applied. Only used when the light does not adjust chromaticity
+  // (ie saturation), so outputs can skip XYZ entirely.
+  virtual void set_color_linear_RGB(float r, float g, float b) {
+    auto XYZ = this->_source_transform * matrices::Vec3(r, g, b);
+    this->set_color_XYZ(XYZ.x, XYZ.y, XYZ.z);
+  }
+
+  // White channels can use the colour temperature as is, rather than solving for it from XYZ.
+  // r, g and b are the same linear source RGB as set_color_linear_RGB() takes, for any other channels.
+  virtual void set_color_CT(const XyCtFrame & /*ct*/, float r, float g, float b) { this->write_linear_RGB(r, g, b); }
+
+  // As set_color_CT(), with the white balanced XYZ of the colour for any other channels (ie stepped transitions,
+  // where the source transform is not for the colour temperature of each tick)
+  virtual void set_color_CT_XYZ(const XyCtFrame & /*ct*/, float X, float Y, float Z) { this->set_color_XYZ(X, Y, Z); }
+
+  // Entry point for linear source RGB, which goes through the 3D LUT when one is enabled and up to date
+  void write_linear_RGB(float r, float g, float b) {
+    if (!this->_lut_valid) {
+      this->set_color_linear_RGB(r, g, b);
+      return;
+    }
+
+    float levels[Lut3d::MAX_CHANNELS];
+    auto &lut = this->_lut.value();
+    lut.lookup(r, g, b, levels);
+    for (uint8_t i = 0; i < lut.channels(); i++) {
+      this->write_level(*this->_lut_channels[i], levels[i]);
+    }
+    this->commit_frame();
+  }
+
+  // grid_size points per axis (ie 17 or 33), or 0 to disable
+  void set_lut_grid_size(uint8_t grid_size) {
+    this->_lut_grid_size = grid_size;
+    this->_lut.reset();
+    this->_lut_valid = false;
+    this->_lut_next_row = 0;
+  }
+
+  // Builds rows of the LUT for the current source transform until budget_us has passed (at least one row).
+  // Returns true once the table is up to date, or when there is no table.
+  bool build_lut_rows(uint32_t budget_us);
+
+  // Compares the LUT against the exact pipeline at the centre of each of its cells. Slow, intended for verification.
+  Lut3dReport lut_report();
+
+  void set_bit_depth(uint8_t bit_depth) {
+    this->_bit_depth = bit_depth;
+    this->_max_duty = (uint32_t(1) << bit_depth) - 1;
+    this->_duty_scale = 1.0f / (float) this->_max_duty;
+  }
+
+  // The light holds the frames of all of its outputs while calculating them, then commits them together
+  void hold_frame() { this->_frame_held = true; }
+  void release_frame() {
+    this->_frame_held = false;
+    this->commit_frame();
+  }
+
+  void set_frame_sink(XyFrameSink *sink) { this->_frame_sink = sink; }
+  XyFrameSink *get_frame_sink() { return this->_frame_sink; }
+
+  // Write and suppressed write counts of each channel
+  virtual std::vector<XyChannel *> channels() { return {}; }
+
+  // Light mixed from the given channel levels (in channels() order), ignoring intensity calibration.
+  // Used to estimate the colour error of the LUT.
+  virtual optional<color_space::XYZ_Cie1931> levels_to_XYZ(const float * /*levels*/) { return {}; }
 };
 
 };  // namespace xy_light
-};  // namespace esphome
\ No newline at end of file
+};  // namespace esphome
@@ -1,8 +1,11 @@
 import esphome.config_validation as cv
 import esphome.codegen as cg
+from esphome.core import CORE
 
 xy_light_ns = cg.esphome_ns.namespace("xy_light")
 XyOutput = xy_light_ns.output_ns.class_("XyOutput")
+XyFrameSink = xy_light_ns.class_("XyFrameSink")
+CalibrationTelemetry = xy_light_ns.class_("CalibrationTelemetry", cg.Component)
 
 CONF_XY_OUTPUT_RGB_COLOR_PROFILE_ID = "rgb_profile_id"
 CONF_XY_OUTPUT_RGB_COLOR_PROFILE = "rgb_profile"
@@ -20,5 +23,16 @@ CONF_XY_OUTPUT_WARM_WHITE_OUTPUT_ID = "warm_white"
 CONF_XY_OUTPUT_COLD_WHITE_OUTPUT_ID = "cold_white"
 
 CONF_XY_OUTPUT_CALIBRATION_LOGGING = "calibration_logging"
+CONF_XY_OUTPUT_BIT_DEPTH = "bit_depth"
+CONF_XY_OUTPUT_FRAME_SINK_ID = "frame_sink_id"
 
 
+async def to_calibration_logging_code(var):
+    cg.add(var.enable_calibration_logging(True))
+
+    # Samples from every light and output share one telemetry ring, which logs them from its own loop
+    if CORE.data.setdefault("xy_light", {}).get("calibration_telemetry"):
+        return
+    CORE.data["xy_light"]["calibration_telemetry"] = True
+    telemetry = cg.RawExpression("esphome::xy_light::CalibrationTelemetry::instance()")
+    cg.add(cg.App.register_component(telemetry))
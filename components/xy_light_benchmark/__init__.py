@@ -0,0 +1,22 @@
+import esphome.codegen as cg
+import esphome.config_validation as cv
+from esphome.const import CONF_ID
+
+CODEOWNERS = ["@jamesjharper"]
+AUTO_LOAD = ["output", "light", "xy_light"]
+
+CONF_ITERATIONS = "iterations"
+
+xy_light_benchmark_ns = cg.esphome_ns.namespace("xy_light_benchmark")
+XyLightBenchmark = xy_light_benchmark_ns.class_("XyLightBenchmark", cg.Component)
+
+CONFIG_SCHEMA = cv.Schema({
+    cv.GenerateID(): cv.declare_id(XyLightBenchmark),
+    cv.Optional(CONF_ITERATIONS, default=100000): cv.int_range(min=1),
+}).extend(cv.COMPONENT_SCHEMA)
+
+
+async def to_code(config):
+    var = cg.new_Pvariable(config[CONF_ID])
+    cg.add(var.set_iterations(config[CONF_ITERATIONS]))
+    await cg.register_component(var, config)
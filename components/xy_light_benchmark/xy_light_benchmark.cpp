@@ -0,0 +1,525 @@
+#include "esphome/components/xy_light_benchmark/xy_light_benchmark.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+#include "esphome/components/xy_light/xy_light.h"
+#include "esphome/components/xy_light/rgb_xy_output.h"
+#include "esphome/components/xy_light/rgbw_xy_output.h"
+#include "esphome/components/xy_light/rgb_cwww_xy_output.h"
+#include "esphome/components/xy_light/cwww_xy_output.h"
+#include "esphome/components/xy_light/white_xy_output.h"
+
+namespace esphome {
+namespace xy_light_benchmark {
+
+using namespace xy_light;
+
+static const char *const TAG = "xy_light_benchmark";
+
+// Inputs are cycled through, so results are not specific to one value (or folded away by the compiler)
+static const uint32_t SAMPLE_COUNT = 256;
+
+// Results are accumulated here so that calls are not optimised out
+static volatile float sink = 0.0f;
+
+template<typename Fn> void XyLightBenchmark::run(const char *name, Fn fn) {
+  // Warm up first, so that lazily built tables and caches are not timed
+  for (uint32_t i = 0; i < SAMPLE_COUNT; i++) {
+    fn(i);
+  }
+
+  auto start = micros();
+  for (uint32_t i = 0; i < this->_iterations; i++) {
+    fn(i % SAMPLE_COUNT);
+  }
+  auto elapsed = micros() - start;
+
+  ESP_LOGI(TAG, "%-40s %10.1f ns", name, ((float) elapsed * 1000.0f) / (float) this->_iterations);
+}
+
+void XyLightBenchmark::check(const char *name, float value, float bound) {
+  if (value <= bound) {
+    ESP_LOGI(TAG, "%-40s %10.6f (max %g)", name, value, bound);
+    return;
+  }
+
+  ESP_LOGE(TAG, "%-40s %10.6f exceeds %g", name, value, bound);
+  this->_checks_failed = true;
+}
+
+void XyLightBenchmark::bench_transfer_functions() {
+  // Tables against the function they replace, sampled far more densely than the knots (and the quarter points the
+  // table's exact toe is found from)
+  static const uint32_t STEPS = 100000;
+
+  struct {
+    const char *name;
+    color_space::TransferFunction::Fn fn;
+    float param;
+  } curves[] = {
+      {"exp_gamma_decompress 2.8", color_space::exp_gamma_decompress, 2.8f},
+      {"exp_gamma_compress 1.8", color_space::exp_gamma_compress, 1.8f},
+      {"srgb_gamma_decompress 2.4", color_space::srgb_gamma_decompress, 2.4f},
+      {"srgb_gamma_compress 2.4", color_space::srgb_gamma_compress, 2.4f},
+  };
+
+  ESP_LOGI(TAG, "Transfer function tables, max |table - exact| over [0, 1]:");
+  for (auto &curve : curves) {
+    for (auto interpolation : {color_space::TransferInterpolation::LINEAR, color_space::TransferInterpolation::CUBIC}) {
+      color_space::TransferFunction table(curve.fn, curve.param, color_space::TransferFunction::DEFAULT_SIZE,
+                                          interpolation);
+      float max_error = 0.0f;
+      for (uint32_t i = 0; i <= STEPS; i++) {
+        auto x = (float) i / (float) STEPS;
+        max_error = std::max(max_error, fabsf(table(x) - curve.fn(x, curve.param)));
+      }
+
+      char name[48];
+      snprintf(name, sizeof(name), "%s, %s", curve.name,
+               interpolation == color_space::TransferInterpolation::LINEAR ? "linear" : "cubic");
+      this->check(name, max_error, color_space::TransferFunction::MAX_TABLE_ERROR);
+    }
+  }
+
+  float x[SAMPLE_COUNT];
+  for (uint32_t i = 0; i < SAMPLE_COUNT; i++) {
+    x[i] = (float) ((i * 97) % SAMPLE_COUNT) / (float) (SAMPLE_COUNT - 1);
+  }
+
+  auto decompress = color_space::TransferFunction::exp_gamma_decompress(2.8f);
+  this->run("powf gamma 2.8", [&](uint32_t i) { sink = sink + color_space::exp_gamma_decompress(x[i], 2.8f); });
+  this->run("TransferFunction gamma 2.8", [&](uint32_t i) { sink = sink + decompress(x[i]); });
+}
+
+void XyLightBenchmark::bench_fixed_point() {
+  // The same values through a float and a fixed point light, comparing the duty codes each output is left with.
+  // The RGB output is calibrated (weighted, min / max and per channel gamma) so calibration is covered too.
+  static const uint32_t RGB_STEPS = 7;
+  const float cts[] = {154.0f, 250.0f, 370.0f, 500.0f};
+  const float brightnesses[] = {0.01f, 0.1f, 0.5f, 1.0f};
+  const float saturations[] = {1.0f, 0.8f, 0.5f};
+
+  RgbProfile led_profile;
+  led_profile.use_typical_led();
+  led_profile.set_weighted_red_intensity(0.9f);
+  led_profile.set_weighted_green_intensity(0.8f);
+  led_profile.set_max_blue_intensity(0.95f);
+  led_profile.set_min_red_intensity(0.02f);
+  led_profile.set_red_gamma(1.1f);
+  led_profile.set_blue_gamma(0.9f);
+  CwWwProfile cwww_profile;
+  cwww_profile.set_cold_white_cct(154.0f);
+  cwww_profile.set_warm_white_cct(370.0f);
+
+  ESP_LOGI(TAG, "Fixed point against float, max duty code deviation:");
+  for (uint8_t bit_depth : {8, 10, 12}) {
+    NullOutput channels[2][8];
+    RgbXyOutput rgb[2];
+    RgbCwWwXyOutput rgb_cwww[2];
+    XyLightOutput lights[2];
+    for (int p = 0; p < 2; p++) {
+      auto *c = channels[p];
+      rgb[p].set_color_profile(&led_profile);
+      rgb[p].set_red_output(&c[0]);
+      rgb[p].set_green_output(&c[1]);
+      rgb[p].set_blue_output(&c[2]);
+      rgb[p].set_bit_depth(bit_depth);
+      rgb_cwww[p].set_color_profile(&led_profile);
+      rgb_cwww[p].set_cwww_profile(&cwww_profile);
+      rgb_cwww[p].set_red_output(&c[3]);
+      rgb_cwww[p].set_green_output(&c[4]);
+      rgb_cwww[p].set_blue_output(&c[5]);
+      rgb_cwww[p].set_cold_white_output(&c[6]);
+      rgb_cwww[p].set_warm_white_output(&c[7]);
+      rgb_cwww[p].set_bit_depth(bit_depth);
+      lights[p].add_output(&rgb[p]);
+      lights[p].add_output(&rgb_cwww[p]);
+      lights[p].enable_fixed_point(p == 1);
+    }
+    auto float_channels = rgb[0].channels();
+    auto fixed_channels = rgb[1].channels();
+    for (auto *channel : rgb_cwww[0].channels())
+      float_channels.push_back(channel);
+    for (auto *channel : rgb_cwww[1].channels())
+      fixed_channels.push_back(channel);
+
+    int32_t max_deviation = 0;
+    uint32_t deviating = 0;
+    uint32_t samples = 0;
+    for (auto ct : cts) {
+      for (auto brightness : brightnesses) {
+        for (auto saturation : saturations) {
+          for (uint32_t i = 0; i < RGB_STEPS * RGB_STEPS * RGB_STEPS; i++) {
+            auto r = (float) (i % RGB_STEPS) / (float) (RGB_STEPS - 1);
+            auto g = (float) ((i / RGB_STEPS) % RGB_STEPS) / (float) (RGB_STEPS - 1);
+            auto b = (float) (i / (RGB_STEPS * RGB_STEPS)) / (float) (RGB_STEPS - 1);
+            for (auto &light : lights) {
+              light.set_color_temperature_value(ct);
+              light.set_brightness_value(brightness);
+              light.set_color_saturation_value(saturation);
+              light.set_rgb_value(r, g, b);
+              light.apply();
+            }
+            for (size_t k = 0; k < float_channels.size(); k++) {
+              auto deviation = abs(float_channels[k]->last_duty - fixed_channels[k]->last_duty);
+              max_deviation = std::max(max_deviation, deviation);
+              deviating += deviation != 0;
+              samples++;
+            }
+          }
+        }
+      }
+    }
+
+    char name[48];
+    snprintf(name, sizeof(name), "%u bit, duty codes (%.2f%% differ)", bit_depth,
+             (100.0f * (float) deviating) / (float) samples);
+    this->check(name, (float) max_deviation, 1.0f);
+  }
+}
+
+void XyLightBenchmark::bench_locus() {
+  // Points either side of the locus over 1000K - 20000K (the solver's valid range), with the mired and Duv they were
+  // made from. The locus is evaluated from the Krystek approximation directly, rather than from the solver's table.
+  static const uint32_t MIRED_STEPS = 500;
+  static const uint32_t DUV_STEPS = 9;
+  float max_mired_error = 0.0f;
+  float max_duv_error = 0.0f;
+  float max_chain_mired_error = 0.0f;
+  uint32_t invalid = 0;
+
+  for (uint32_t i = 0; i <= MIRED_STEPS; i++) {
+    auto mired = 50.0f + (950.0f * (float) i / (float) MIRED_STEPS);
+    auto p = color_space::planckian_locus::evaluate<double>(mired);
+    for (uint32_t j = 0; j < DUV_STEPS; j++) {
+      auto duv = -0.02f + (0.04f * (float) j / (float) (DUV_STEPS - 1));
+      auto u = p.u - (duv * p.tangent_v);
+      auto v = p.v + (duv * p.tangent_u);
+
+      auto solved = color_space::PlanckianLocus::solve(u, v);
+      if (!solved.valid) {
+        invalid++;
+        continue;
+      }
+      max_mired_error = std::max(max_mired_error, fabsf(solved.mired - mired));
+      max_duv_error = std::max(max_duv_error, fabsf(solved.duv - duv));
+
+      auto kelvin = color_space::Uv_Cie1960(u, v).as_xy_cie1931().cct_kelvin_approx();
+      max_chain_mired_error = std::max(max_chain_mired_error, fabsf((1000000.0f / kelvin) - mired));
+    }
+  }
+
+  ESP_LOGI(TAG, "Planckian locus, %" PRIu32 " points within 0.02 Duv:", (MIRED_STEPS + 1) * DUV_STEPS);
+  ESP_LOGI(TAG, "%-40s %10.6f", "cct_kelvin_approx mired error", max_chain_mired_error);
+  this->check("PlanckianLocus::solve mired error", max_mired_error, 0.05f);
+  // The solver replaced McCamy's approximation for the white outputs, so must never be the less accurate of the two
+  this->check("Solver / cct_kelvin_approx mired error", max_mired_error / max_chain_mired_error, 1.0f);
+  this->check("PlanckianLocus::solve Duv error", max_duv_error, 1e-4f);
+  this->check("PlanckianLocus::solve invalid", (float) invalid, 0.0f);
+
+  color_space::Uv_Cie1960 uv[SAMPLE_COUNT];
+  for (uint32_t i = 0; i < SAMPLE_COUNT; i++) {
+    auto p = color_space::PlanckianLocus::at_mired(55.0f + (3.7f * (float) i));
+    auto duv = -0.02f + (0.04f * (float) ((i * 37) % SAMPLE_COUNT) / (float) SAMPLE_COUNT);
+    uv[i] = color_space::Uv_Cie1960(p.u - (duv * p.tangent_v), p.v + (duv * p.tangent_u));
+  }
+
+  this->run("PlanckianLocus::solve", [&](uint32_t i) {
+    auto cct_duv = color_space::PlanckianLocus::solve(uv[i].u, uv[i].v);
+    sink = sink + cct_duv.mired + cct_duv.duv;
+  });
+  // What the white outputs did before the solver, a polygon test and Duv approximation then McCamy
+  this->run("tint_impurity + cct_kelvin_approx", [&](uint32_t i) {
+    sink = sink + uv[i].tint_impurity(0.06f, 0.05f) + uv[i].as_xy_cie1931().cct_kelvin_approx();
+  });
+}
+
+void XyLightBenchmark::bench_frame_writes() {
+  // A 10 s colour temperature and brightness fade at 60 fps, counting what a bus attached chip would see with each
+  // channel written on its own, and with each output's changed channels batched into one frame
+  static const uint32_t FRAMES = 600;
+
+  RgbProfile rgb_profile;
+  rgb_profile.use_typical_led();
+  CwWwProfile cwww_profile;
+  cwww_profile.set_cold_white_cct(154.0f);
+  cwww_profile.set_warm_white_cct(370.0f);
+
+  ESP_LOGI(TAG, "Bus writes, rgb_cwww output, %" PRIu32 " frame CT and brightness fade:", FRAMES);
+  for (uint8_t bit_depth : {12, 16}) {
+    NullOutput channels[5];
+    CountingFrameSink bus;
+    RgbCwWwXyOutput output;
+    output.set_color_profile(&rgb_profile);
+    output.set_cwww_profile(&cwww_profile);
+    output.set_red_output(&channels[0]);
+    output.set_green_output(&channels[1]);
+    output.set_blue_output(&channels[2]);
+    output.set_cold_white_output(&channels[3]);
+    output.set_warm_white_output(&channels[4]);
+    output.set_bit_depth(bit_depth);
+    output.set_frame_sink(&bus);
+
+    XyLightOutput light;
+    light.add_output(&output);
+    for (uint32_t i = 0; i < FRAMES; i++) {
+      auto t = (float) i / (float) (FRAMES - 1);
+      light.set_color_temperature_value(370.0f - (216.0f * t));
+      light.set_brightness_value(0.2f + (0.8f * t));
+      light.apply();
+    }
+
+    char name[48];
+    snprintf(name, sizeof(name), "%u bit, per channel writes / frame", bit_depth);
+    ESP_LOGI(TAG, "%-40s %10.2f (%.2f before suppression)", name, (float) bus.channel_writes / (float) FRAMES, 5.0f);
+    snprintf(name, sizeof(name), "%u bit, batched writes / frame", bit_depth);
+    this->check(name, (float) bus.frames / (float) FRAMES, 1.0f);
+  }
+}
+
+void XyLightBenchmark::bench_lut() {
+  // A colour temperature fade moves the white point every frame, so the LUT is bypassed rather than rebuilt, and no
+  // frame should take much longer than an exact evaluation (a 17 point rgb_cwww table takes milliseconds to build)
+  static const uint32_t FRAMES = 600;
+  static const uint32_t MAX_FRAME_US = 500;
+
+  RgbProfile rgb_profile;
+  rgb_profile.use_typical_led();
+  CwWwProfile cwww_profile;
+  cwww_profile.set_cold_white_cct(154.0f);
+  cwww_profile.set_warm_white_cct(370.0f);
+
+  NullOutput channels[5];
+  RgbCwWwXyOutput output;
+  output.set_color_profile(&rgb_profile);
+  output.set_cwww_profile(&cwww_profile);
+  output.set_red_output(&channels[0]);
+  output.set_green_output(&channels[1]);
+  output.set_blue_output(&channels[2]);
+  output.set_cold_white_output(&channels[3]);
+  output.set_warm_white_output(&channels[4]);
+
+  XyLightOutput light;
+  light.add_output(&output);
+  light.set_lut_grid_size(17);
+
+  ESP_LOGI(TAG, "LUT 17, rgb_cwww output, %" PRIu32 " frames:", FRAMES);
+  uint32_t slowest = 0;
+  auto start = micros();
+  for (uint32_t i = 0; i < FRAMES; i++) {
+    auto frame_start = micros();
+    light.set_color_temperature_value(370.0f - (216.0f * (float) i / (float) (FRAMES - 1)));
+    light.set_rgb_value((float) (i % 7) / 6.0f, (float) (i % 5) / 4.0f, (float) (i % 3) / 2.0f);
+    light.apply();
+    slowest = std::max(slowest, micros() - frame_start);
+  }
+  ESP_LOGI(TAG, "%-40s %10.1f ns", "CT fade, exact while changing", (float) (micros() - start) * 1000.0f / FRAMES);
+  this->check("CT fade, slowest frame (us)", (float) slowest, (float) MAX_FRAME_US);
+
+  start = micros();
+  output.build_lut_rows(UINT32_MAX);
+  ESP_LOGI(TAG, "%-40s %10" PRIu32 " us", "Table build, off the render path", micros() - start);
+
+  start = micros();
+  for (uint32_t i = 0; i < FRAMES; i++) {
+    light.set_rgb_value((float) (i % 7) / 6.0f, (float) (i % 5) / 4.0f, (float) (i % 3) / 2.0f);
+    light.apply();
+  }
+  ESP_LOGI(TAG, "%-40s %10.1f ns", "Static CT, from the table", (float) (micros() - start) * 1000.0f / FRAMES);
+}
+
+void XyLightBenchmark::bench_uv_lut() {
+  // The CW/WW levels from the uv table against the exact CCT / Duv solve, for random colours and ones close to the
+  // locus (where the white channels do most of their work). Levels are after calibration, clamped to the output range.
+  static const uint32_t RANDOM_POINTS = 20000;
+  static const uint32_t LOCUS_POINTS = 20000;
+  const struct {
+    uint8_t grid_size;
+    float bound;
+  } grids[] = {{8, 0.3f}, {16, 0.2f}, {32, 0.04f}, {64, 0.015f}};
+
+  CwWwProfile exact_profile;
+  exact_profile.set_cold_white_cct(154.0f);
+  exact_profile.set_warm_white_cct(370.0f);
+  auto exact = exact_profile.get_chroma_transform();
+
+  // Points are generated as they are compared (too many to hold on a device), the same sequence for each grid size
+  uint32_t seed;
+  auto random = [&seed]() {
+    seed = (seed * 1664525u) + 1013904223u;
+    return (float) (seed >> 8) / (float) (1u << 24);
+  };
+  auto point = [&](uint32_t i) {
+    if (i < RANDOM_POINTS) {
+      auto xy = color_space::Xy_Cie1931(0.05f + (0.7f * random()), 0.05f + (0.8f * random()));
+      return xy.as_XYZ_cie1931(0.01f + (0.99f * random()));
+    }
+    auto cct = color_space::Cct::from_kelvin(1500.0f + (18500.0f * random()));
+    auto uv = cct.delta_uv_cie1960(0.03f * (random() - 0.5f));
+    return uv.as_xy_cie1931().as_XYZ_cie1931(0.01f + (0.99f * random()));
+  };
+
+  ESP_LOGI(TAG, "CW/WW uv table against the exact solve, %" PRIu32 " points, max level error:",
+           RANDOM_POINTS + LOCUS_POINTS);
+  for (auto &grid : grids) {
+    CwWwProfile lut_profile;
+    lut_profile.set_cold_white_cct(154.0f);
+    lut_profile.set_warm_white_cct(370.0f);
+    lut_profile.set_uv_lut_grid_size(grid.grid_size);
+    auto lut = lut_profile.get_chroma_transform();
+
+    float max_error = 0.0f;
+    seed = 1;
+    for (uint32_t i = 0; i < RANDOM_POINTS + LOCUS_POINTS; i++) {
+      auto XYZ = point(i);
+      auto a = exact.XYZ_to_CwWw(XYZ), b = lut.XYZ_to_CwWw(XYZ);
+      max_error = std::max(max_error, fabsf(clamp(a.cw, 0.0f, 1.0f) - clamp(b.cw, 0.0f, 1.0f)));
+      max_error = std::max(max_error, fabsf(clamp(a.ww, 0.0f, 1.0f) - clamp(b.ww, 0.0f, 1.0f)));
+    }
+
+    char name[48];
+    snprintf(name, sizeof(name), "uv_lut_grid_size %u", grid.grid_size);
+    this->check(name, max_error, grid.bound);
+
+    if (grid.grid_size == 32) {
+      // Half random, half near the locus
+      color_space::XYZ_Cie1931 XYZ[SAMPLE_COUNT];
+      for (uint32_t i = 0; i < SAMPLE_COUNT; i++)
+        XYZ[i] = point(i % 2 == 0 ? 0 : RANDOM_POINTS);
+      this->run("XYZ_to_CwWw, exact", [&](uint32_t i) { sink = sink + exact.XYZ_to_CwWw(XYZ[i]).cw; });
+      this->run("XYZ_to_CwWw, uv table 32", [&](uint32_t i) { sink = sink + lut.XYZ_to_CwWw(XYZ[i]).cw; });
+    }
+  }
+}
+
+void XyLightBenchmark::setup() {
+  // Colours around the Planckian locus (where white channels are active), and across the rest of the gamut
+  float kelvin[SAMPLE_COUNT];
+  color_space::Xy_Cie1931 xy[SAMPLE_COUNT];
+  color_space::XYZ_Cie1931 XYZ[SAMPLE_COUNT];
+  color_space::RGB rgb[SAMPLE_COUNT];
+
+  for (uint32_t i = 0; i < SAMPLE_COUNT; i++) {
+    float t = (float) i / (float) (SAMPLE_COUNT - 1);
+    kelvin[i] = 1000.0f + (t * 19000.0f);
+
+    if (i % 2 == 0) {
+      auto uv = color_space::Cct::from_kelvin(1500.0f + (t * 8500.0f)).delta_uv_cie1960((t - 0.5f) * 0.04f);
+      xy[i] = uv.as_xy_cie1931();
+    } else {
+      xy[i] = color_space::Xy_Cie1931(0.15f + (0.5f * t), 0.1f + (0.5f * ((i * 37) % SAMPLE_COUNT) / SAMPLE_COUNT));
+    }
+    XYZ[i] = xy[i].as_XYZ_cie1931(0.05f + (0.95f * t));
+
+    rgb[i] = color_space::RGB(t, (float) ((i * 97) % SAMPLE_COUNT) / SAMPLE_COUNT,
+                              (float) ((i * 151) % SAMPLE_COUNT) / SAMPLE_COUNT);
+  }
+
+  ESP_LOGI(TAG, "Colour core, %" PRIu32 " iterations each:", this->_iterations);
+
+  this->run("Cct::from_kelvin", [&](uint32_t i) { sink = sink + color_space::Cct::from_kelvin(kelvin[i]).uv.u; });
+
+  this->run("Uv_Cie1960::duv_approx", [&](uint32_t i) { sink = sink + xy[i].as_uv_cie1960().duv_approx(); });
+
+  this->run("Xy_Cie1931::cct_kelvin_approx", [&](uint32_t i) { sink = sink + xy[i].cct_kelvin_approx(); });
+
+  RgbProfile rgb_profile;
+  rgb_profile.use_typical_led();
+  auto rgb_transform = rgb_profile.get_chroma_transform();
+  this->run("RgbChromaTransform::XYZ_to_RGB", [&](uint32_t i) { sink = sink + rgb_transform.XYZ_to_RGB(XYZ[i]).r; });
+
+  CwWwProfile cwww_profile;
+  cwww_profile.set_cold_white_cct(154.0f);
+  cwww_profile.set_warm_white_cct(370.0f);
+  cwww_profile.set_gamma(1.8f);
+  auto cwww_transform = cwww_profile.get_chroma_transform();
+  this->run("CwWwChromaTransform::XYZ_to_CwWw", [&](uint32_t i) { sink = sink + cwww_transform.XYZ_to_CwWw(XYZ[i]).cw; });
+
+  WhiteProfile white_profile;
+  white_profile.set_white_point_cct(250.0f);
+  auto white_transform = white_profile.get_chroma_transform();
+  this->run("WhiteChromaTransform::XYZ_to_white",
+            [&](uint32_t i) { sink = sink + white_transform.XYZ_to_white_intensity(XYZ[i]); });
+
+  // Each output type on its own light, with channels writing nowhere
+  NullOutput channels[5];
+
+  RgbXyOutput rgb_output;
+  rgb_output.set_color_profile(&rgb_profile);
+  rgb_output.set_red_output(&channels[0]);
+  rgb_output.set_green_output(&channels[1]);
+  rgb_output.set_blue_output(&channels[2]);
+
+  RgbwXyOutput rgbw_output;
+  rgbw_output.set_color_profile(&rgb_profile);
+  rgbw_output.set_white_profile(&white_profile);
+  rgbw_output.set_red_output(&channels[0]);
+  rgbw_output.set_green_output(&channels[1]);
+  rgbw_output.set_blue_output(&channels[2]);
+  rgbw_output.set_white_output(&channels[3]);
+
+  RgbCwWwXyOutput rgb_cwww_output;
+  rgb_cwww_output.set_color_profile(&rgb_profile);
+  rgb_cwww_output.set_cwww_profile(&cwww_profile);
+  rgb_cwww_output.set_red_output(&channels[0]);
+  rgb_cwww_output.set_green_output(&channels[1]);
+  rgb_cwww_output.set_blue_output(&channels[2]);
+  rgb_cwww_output.set_cold_white_output(&channels[3]);
+  rgb_cwww_output.set_warm_white_output(&channels[4]);
+
+  CwWwXyOutput cwww_output;
+  cwww_output.set_profile(&cwww_profile);
+  cwww_output.set_cold_white_output(&channels[3]);
+  cwww_output.set_warm_white_output(&channels[4]);
+
+  WhiteXyOutput white_output;
+  white_output.set_profile(&white_profile);
+  white_output.set_white_output(&channels[3]);
+
+  struct {
+    const char *name;
+    const char *desaturated_name;
+    XyOutput *output;
+  } outputs[] = {
+      {"XyLightOutput::apply rgb", "XyLightOutput::apply rgb, 80% sat", &rgb_output},
+      {"XyLightOutput::apply rgbw", "XyLightOutput::apply rgbw, 80% sat", &rgbw_output},
+      {"XyLightOutput::apply rgb_cwww", "XyLightOutput::apply rgb_cwww, 80% sat", &rgb_cwww_output},
+      {"XyLightOutput::apply cwww", "XyLightOutput::apply cwww, 80% sat", &cwww_output},
+      {"XyLightOutput::apply white", "XyLightOutput::apply white, 80% sat", &white_output},
+  };
+
+  for (auto &o : outputs) {
+    XyLightOutput light;
+    light.add_output(o.output);
+
+    // Full saturation takes the linear RGB path, anything less goes through XYZ
+    for (float saturation : {1.0f, 0.8f}) {
+      light.set_color_saturation_value(saturation);
+      this->run(saturation == 1.0f ? o.name : o.desaturated_name, [&](uint32_t i) {
+        light.set_rgb_value(rgb[i].r, rgb[i].g, rgb[i].b);
+        light.apply();
+      });
+    }
+  }
+
+  this->bench_transfer_functions();
+  this->bench_fixed_point();
+  this->bench_locus();
+  this->bench_frame_writes();
+  this->bench_lut();
+  this->bench_uv_lut();
+
+  if (this->_checks_failed) {
+    ESP_LOGE(TAG, "Accuracy checks failed");
+    this->mark_failed();
+  }
+}
+
+}  // namespace xy_light_benchmark
+}  // namespace esphome
@@ -0,0 +1,60 @@
+#pragma once
+#include <stdint.h>
+
+#include "esphome/core/component.h"
+#include "esphome/components/output/float_output.h"
+#include "esphome/components/xy_light/xy_output.h"
+
+namespace esphome {
+namespace xy_light_benchmark {
+
+// Discards its level, so that benchmarks time the colour pipeline rather than a driver
+class NullOutput : public output::FloatOutput {
+ protected:
+  void write_state(float state) override {}
+};
+
+// Stands in for a bus attached PWM chip, counting transactions as the channel writes would reach it.
+// One per changed channel when the chip is written through FloatOutputs, or one per frame when batched.
+class CountingFrameSink : public xy_light::XyFrameSink {
+ public:
+  uint32_t frames = 0;
+  uint32_t channel_writes = 0;
+
+  void commit_frame(const xy_light::XyFrame &frame) override {
+    this->frames++;
+    this->channel_writes += frame.size;
+  }
+};
+
+// Times the colour core functions, and XyLightOutput::apply() for each output type, once from setup().
+// Also checks the accuracy of the table driven and approximate paths against the exact ones, marking the component
+// failed if any is outside of its bound. Runs on a device, or natively on Linux with ESPHome's host platform
+// (see benchmark.yaml).
+class XyLightBenchmark : public Component {
+ protected:
+  uint32_t _iterations = 100000;
+  bool _checks_failed = false;
+
+  template<typename Fn> void run(const char *name, Fn fn);
+
+  // Logs a measured error, failing the benchmark if it is above the bound
+  void check(const char *name, float value, float bound);
+
+  void bench_transfer_functions();
+  void bench_fixed_point();
+  void bench_locus();
+  void bench_frame_writes();
+  void bench_lut();
+  void bench_uv_lut();
+
+ public:
+  void set_iterations(uint32_t iterations) { this->_iterations = iterations; }
+
+  void setup() override;
+
+  float get_setup_priority() const override { return setup_priority::LATE; }
+};
+
+}  // namespace xy_light_benchmark
+}  // namespace esphome
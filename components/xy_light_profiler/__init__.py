@@ -0,0 +1,24 @@
+import esphome.codegen as cg
+import esphome.config_validation as cv
+from esphome.const import CONF_ID
+
+CODEOWNERS = ["@jamesjharper"]
+AUTO_LOAD = ["xy_light"]
+MULTI_CONF = False
+
+CONF_XY_LIGHT_PROFILER_ID = "xy_light_profiler_id"
+
+xy_light_profiler_ns = cg.esphome_ns.namespace("xy_light_profiler")
+XyLightProfiler = xy_light_profiler_ns.class_("XyLightProfiler", cg.PollingComponent)
+
+CONFIG_SCHEMA = cv.Schema({
+    cv.GenerateID(): cv.declare_id(XyLightProfiler),
+}).extend(cv.polling_component_schema("60s"))
+
+
+async def to_code(config):
+    # Compiles the instrumentation into the colour pipeline, it is left out entirely otherwise
+    cg.add_define("USE_XY_LIGHT_PROFILING")
+
+    var = cg.new_Pvariable(config[CONF_ID])
+    await cg.register_component(var, config)
@@ -0,0 +1,47 @@
+import esphome.codegen as cg
+import esphome.config_validation as cv
+from esphome.components import sensor
+from esphome.const import STATE_CLASS_MEASUREMENT
+
+from . import (CONF_XY_LIGHT_PROFILER_ID, XyLightProfiler, xy_light_profiler_ns)
+
+DEPENDENCIES = ["xy_light_profiler"]
+
+CONF_STAGE = "stage"
+CONF_STATISTIC = "statistic"
+
+ProfileStage = cg.esphome_ns.namespace("xy_light").enum("ProfileStage")
+Statistic = xy_light_profiler_ns.enum("Statistic", is_class=True)
+
+STAGES = {
+    "decode": ProfileStage.PROFILE_DECODE,
+    "saturation": ProfileStage.PROFILE_SATURATION,
+    "white_balance": ProfileStage.PROFILE_WHITE_BALANCE,
+    "output_transform": ProfileStage.PROFILE_OUTPUT_TRANSFORM,
+    "calibration": ProfileStage.PROFILE_CALIBRATION,
+    "commit": ProfileStage.PROFILE_COMMIT,
+}
+
+STATISTICS = {
+    "min": Statistic.MIN,
+    "p50": Statistic.P50,
+    "p99": Statistic.P99,
+    "max": Statistic.MAX,
+}
+
+CONFIG_SCHEMA = sensor.sensor_schema(
+    unit_of_measurement="µs",
+    icon="mdi:timer-outline",
+    accuracy_decimals=2,
+    state_class=STATE_CLASS_MEASUREMENT,
+).extend({
+    cv.GenerateID(CONF_XY_LIGHT_PROFILER_ID): cv.use_id(XyLightProfiler),
+    cv.Required(CONF_STAGE): cv.enum(STAGES, lower=True),
+    cv.Optional(CONF_STATISTIC, default="p99"): cv.enum(STATISTICS, lower=True),
+})
+
+
+async def to_code(config):
+    profiler = await cg.get_variable(config[CONF_XY_LIGHT_PROFILER_ID])
+    var = await sensor.new_sensor(config)
+    cg.add(profiler.add_sensor(config[CONF_STAGE], config[CONF_STATISTIC], var))
@@ -0,0 +1,62 @@
+#include "esphome/components/xy_light_profiler/xy_light_profiler.h"
+
+#include <cinttypes>
+#include <math.h>
+
+#include "esphome/core/log.h"
+
+namespace esphome {
+namespace xy_light_profiler {
+
+using namespace xy_light;
+
+static const char *const TAG = "xy_light_profiler";
+
+#ifdef USE_SENSOR
+static uint32_t statistic_ticks(const TickHistogram &h, Statistic statistic) {
+  switch (statistic) {
+    case Statistic::MIN:
+      return h.min();
+    case Statistic::P50:
+      return h.percentile(0.5f);
+    case Statistic::P99:
+      return h.percentile(0.99f);
+    case Statistic::MAX:
+    default:
+      return h.max();
+  }
+}
+#endif
+
+void XyLightProfiler::dump_config() {
+  ESP_LOGCONFIG(TAG, "XY Light Profiler:");
+  LOG_UPDATE_INTERVAL(this);
+}
+
+void XyLightProfiler::update() {
+  auto *profiler = StageProfiler::instance();
+
+  ESP_LOGI(TAG, "Colour pipeline stages (us per call):");
+  for (uint8_t i = 0; i < PROFILE_STAGE_COUNT; i++) {
+    auto stage = (ProfileStage) i;
+    auto &h = profiler->histogram(stage);
+    if (h.count() == 0)
+      continue;
+
+    ESP_LOGI(TAG, "  %-16s %7" PRIu32 " calls, min %.2f, p50 %.2f, p99 %.2f, max %.2f", StageProfiler::stage_name(stage),
+             h.count(), StageProfiler::ticks_to_us(h.min()), StageProfiler::ticks_to_us(h.percentile(0.5f)),
+             StageProfiler::ticks_to_us(h.percentile(0.99f)), StageProfiler::ticks_to_us(h.max()));
+  }
+
+#ifdef USE_SENSOR
+  for (auto &s : this->_sensors) {
+    auto &h = profiler->histogram(s.stage);
+    s.sensor->publish_state(h.count() ? StageProfiler::ticks_to_us(statistic_ticks(h, s.statistic)) : NAN);
+  }
+#endif
+
+  profiler->reset();
+}
+
+}  // namespace xy_light_profiler
+}  // namespace esphome
@@ -0,0 +1,45 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+
+#include "esphome/core/component.h"
+#include "esphome/core/defines.h"
+#include "esphome/components/xy_light/profiling.h"
+
+#ifdef USE_SENSOR
+#include "esphome/components/sensor/sensor.h"
+#endif
+
+namespace esphome {
+namespace xy_light_profiler {
+
+enum class Statistic : uint8_t { MIN, P50, P99, MAX };
+
+// Logs the time spent in each stage of every light's colour pipeline (min, p50, p99 and max per call) every
+// update_interval, then starts over. Adding this component is what compiles the pipeline's instrumentation in.
+class XyLightProfiler : public PollingComponent {
+ protected:
+#ifdef USE_SENSOR
+  struct StageSensor {
+    xy_light::ProfileStage stage;
+    Statistic statistic;
+    sensor::Sensor *sensor;
+  };
+  std::vector<StageSensor> _sensors;
+#endif
+
+ public:
+#ifdef USE_SENSOR
+  // Published in microseconds
+  void add_sensor(xy_light::ProfileStage stage, Statistic statistic, sensor::Sensor *sensor) {
+    this->_sensors.push_back({stage, statistic, sensor});
+  }
+#endif
+
+  void update() override;
+
+  void dump_config() override;
+};
+
+}  // namespace xy_light_profiler
+}  // namespace esphome
@@ -0,0 +1,161 @@
+import csv
+
+import esphome.codegen as cg
+import esphome.config_validation as cv
+from esphome.const import CONF_ID
+from esphome.core import CORE
+
+from esphome.components.xy_light.light import CONTROL_TYPES
+from esphome.components.xy_light import command_trace
+from esphome.components.xy_light.rgb_profile import (RGB_PROFILE_CONFIG_SCHEMA, to_rgb_profile_code)
+from esphome.components.xy_light.cwww_profile import (CWWW_PROFILE_CONFIG_SCHEMA, to_cwww_profile_code)
+from esphome.components.xy_light.white_profile import (WHITE_PROFILE_CONFIG_SCHEMA, to_white_profile_code)
+
+CODEOWNERS = ["@jamesjharper"]
+AUTO_LOAD = ["output", "light", "xy_light"]
+# Several simulations (ie of the same trace through different render paths) can run from one config
+MULTI_CONF = True
+
+CONF_TRACE = "trace"
+CONF_FIXTURES = "fixtures"
+CONF_FIXTURE_TYPE = "fixture_type"
+CONF_CONTROL_TYPE = "control_type"
+CONF_BIT_DEPTH = "bit_depth"
+CONF_FRAME_INTERVAL = "frame_interval"
+CONF_GAMMA_CORRECT = "gamma_correct"
+CONF_OUTPUT_TRACE = "output_trace"
+CONF_CHECK_FRAMES = "check_frames"
+CONF_OFFLOAD = "offload"
+CONF_ASYNC_WRITE = "async_write"
+CONF_RGB_PROFILE = "rgb_profile"
+CONF_CWWW_PROFILE = "cwww_profile"
+CONF_WHITE_PROFILE = "white_profile"
+
+TRACE_COLUMNS = ["time_ms", "transition_ms", "state", "brightness", "red", "green", "blue", "color_temperature"]
+
+xy_light_simulator_ns = cg.esphome_ns.namespace("xy_light_simulator")
+XyLightSimulator = xy_light_simulator_ns.class_("XyLightSimulator", cg.Component)
+FixtureType = xy_light_simulator_ns.enum("FixtureType", is_class=True)
+
+FIXTURE_TYPES = {
+    "RGB": FixtureType.RGB,
+    "RGBW": FixtureType.RGBW,
+    "RGB_CWWW": FixtureType.RGB_CWWW,
+    "CWWW": FixtureType.CWWW,
+    "W": FixtureType.WHITE,
+}
+
+
+def read_binary_trace(path):
+    # Captured by a light's command_trace, every write is replayed as is
+    keyframes = []
+    start = None
+    try:
+        with open(path, "rb") as f:
+            for r in command_trace.iter_records(f):
+                start = r.time_ms if start is None else start
+                keyframes.append((r.time_ms - start, 0, r.state, r.brightness, r.red, r.green, r.blue,
+                                  r.color_temperature))
+    except command_trace.TraceError as err:
+        raise cv.Invalid(f"{path}: {err}") from err
+    return keyframes
+
+
+def read_trace(path):
+    # Rows of TRACE_COLUMNS, blank lines and lines starting with # are ignored
+    keyframes = []
+    last_time = 0
+    path = CORE.relative_config_path(path)
+    if command_trace.is_binary_trace(path):
+        keyframes = read_binary_trace(path)
+        if not keyframes:
+            raise cv.Invalid(f"{path}: trace has no keyframes")
+        return keyframes
+
+    with open(path, newline="") as f:
+        for line_number, row in enumerate(csv.reader(f), start=1):
+            if not row or row[0].strip().startswith("#"):
+                continue
+            if len(row) != len(TRACE_COLUMNS):
+                raise cv.Invalid(f"{path}:{line_number}: expected {len(TRACE_COLUMNS)} columns ({', '.join(TRACE_COLUMNS)})")
+            try:
+                time_ms = int(row[0])
+                transition_ms = int(row[1])
+                values = [float(v) for v in row[2:]]
+            except ValueError as err:
+                raise cv.Invalid(f"{path}:{line_number}: {err}") from err
+            if time_ms < last_time:
+                raise cv.Invalid(f"{path}:{line_number}: keyframes must be in time order")
+            last_time = time_ms
+            keyframes.append((time_ms, transition_ms, *values))
+
+    if not keyframes:
+        raise cv.Invalid(f"{path}: trace has no keyframes")
+    return keyframes
+
+
+def validate_trace(value):
+    value = cv.file_(value)
+    read_trace(value)
+    return value
+
+
+CONFIG_SCHEMA = cv.Schema({
+    cv.GenerateID(): cv.declare_id(XyLightSimulator),
+    cv.Required(CONF_TRACE): validate_trace,
+    cv.Optional(CONF_FIXTURES, default=1): cv.int_range(min=1, max=10000),
+    cv.Optional(CONF_FIXTURE_TYPE, default="RGB_CWWW"): cv.enum(FIXTURE_TYPES, upper=True, space="_"),
+    cv.Optional(CONF_CONTROL_TYPE, default="RGB_CT"): cv.enum(CONTROL_TYPES, upper=True, space="_"),
+    cv.Optional(CONF_BIT_DEPTH, default=12): cv.int_range(min=1, max=16),
+    cv.Optional(CONF_FRAME_INTERVAL, default="16ms"): cv.positive_time_period_milliseconds,
+    cv.Optional(CONF_GAMMA_CORRECT, default=2.8): cv.positive_float,
+    cv.Optional(CONF_OUTPUT_TRACE, default=False): cv.boolean,
+    cv.Optional(CONF_CHECK_FRAMES, default=False): cv.boolean,
+    cv.Optional(CONF_OFFLOAD, default=False): cv.boolean,
+    cv.Optional(CONF_ASYNC_WRITE, default=False): cv.boolean,
+    cv.Optional(CONF_RGB_PROFILE): RGB_PROFILE_CONFIG_SCHEMA,
+    cv.Optional(CONF_CWWW_PROFILE): CWWW_PROFILE_CONFIG_SCHEMA,
+    cv.Optional(CONF_WHITE_PROFILE): WHITE_PROFILE_CONFIG_SCHEMA,
+}).extend(cv.COMPONENT_SCHEMA)
+
+
+async def to_code(config):
+    var = cg.new_Pvariable(config[CONF_ID])
+    cg.add(var.set_fixture_count(config[CONF_FIXTURES]))
+    cg.add(var.set_fixture_type(config[CONF_FIXTURE_TYPE]))
+    cg.add(var.set_control_type(config[CONF_CONTROL_TYPE]))
+    cg.add(var.set_bit_depth(config[CONF_BIT_DEPTH]))
+    cg.add(var.set_frame_interval(config[CONF_FRAME_INTERVAL]))
+    cg.add(var.set_gamma_correct(config[CONF_GAMMA_CORRECT]))
+
+    if config[CONF_OUTPUT_TRACE]:
+        cg.add(var.enable_output_trace(True))
+
+    if config[CONF_CHECK_FRAMES]:
+        cg.add(var.enable_check_frames(True))
+
+    if config[CONF_OFFLOAD]:
+        cg.add(var.enable_offload(True))
+
+    if config[CONF_ASYNC_WRITE]:
+        cg.add(var.enable_async_write(True))
+
+    if CONF_RGB_PROFILE in config:
+        await to_rgb_profile_code(config[CONF_RGB_PROFILE])
+        profile = await cg.get_variable(config[CONF_RGB_PROFILE][CONF_ID])
+        cg.add(var.set_rgb_profile(profile))
+
+    if CONF_CWWW_PROFILE in config:
+        await to_cwww_profile_code(config[CONF_CWWW_PROFILE])
+        profile = await cg.get_variable(config[CONF_CWWW_PROFILE][CONF_ID])
+        cg.add(var.set_cwww_profile(profile))
+
+    if CONF_WHITE_PROFILE in config:
+        await to_white_profile_code(config[CONF_WHITE_PROFILE])
+        profile = await cg.get_variable(config[CONF_WHITE_PROFILE][CONF_ID])
+        cg.add(var.set_white_profile(profile))
+
+    for keyframe in read_trace(config[CONF_TRACE]):
+        cg.add(var.add_keyframe(*keyframe))
+
+    await cg.register_component(var, config)
@@ -0,0 +1,279 @@
+#include "esphome/components/xy_light_simulator/xy_light_simulator.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <stdio.h>
+
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+#include "esphome/components/xy_light/rgb_xy_output.h"
+#include "esphome/components/xy_light/rgbw_xy_output.h"
+#include "esphome/components/xy_light/rgb_cwww_xy_output.h"
+#include "esphome/components/xy_light/cwww_xy_output.h"
+#include "esphome/components/xy_light/white_xy_output.h"
+
+namespace esphome {
+namespace xy_light_simulator {
+
+using namespace xy_light;
+
+static const char *const TAG = "xy_light_simulator";
+
+void XyLightSimulator::add_keyframe(uint32_t time_ms, uint32_t transition_ms, float state, float brightness,
+                                    float red, float green, float blue, float color_temperature) {
+  light::LightColorValues values;
+  values.set_state(state);
+  values.set_brightness(brightness);
+  values.set_red(red);
+  values.set_green(green);
+  values.set_blue(blue);
+  values.set_color_temperature(color_temperature);
+  this->_keyframes.push_back({time_ms, transition_ms, values});
+}
+
+std::unique_ptr<Fixture> XyLightSimulator::make_fixture() {
+  auto fixture = std::make_unique<Fixture>();
+  auto *c = fixture->channels;
+
+  switch (this->_fixture_type) {
+    case FixtureType::RGB: {
+      auto output = std::make_unique<RgbXyOutput>();
+      output->set_color_profile(this->_rgb_profile);
+      output->set_red_output(&c[0]);
+      output->set_green_output(&c[1]);
+      output->set_blue_output(&c[2]);
+      fixture->output = std::move(output);
+      fixture->channel_count = 3;
+      break;
+    }
+    case FixtureType::RGBW: {
+      auto output = std::make_unique<RgbwXyOutput>();
+      output->set_color_profile(this->_rgb_profile);
+      output->set_white_profile(this->_white_profile);
+      output->set_red_output(&c[0]);
+      output->set_green_output(&c[1]);
+      output->set_blue_output(&c[2]);
+      output->set_white_output(&c[3]);
+      fixture->output = std::move(output);
+      fixture->channel_count = 4;
+      break;
+    }
+    case FixtureType::RGB_CWWW: {
+      auto output = std::make_unique<RgbCwWwXyOutput>();
+      output->set_color_profile(this->_rgb_profile);
+      output->set_cwww_profile(this->_cwww_profile);
+      output->set_red_output(&c[0]);
+      output->set_green_output(&c[1]);
+      output->set_blue_output(&c[2]);
+      output->set_cold_white_output(&c[3]);
+      output->set_warm_white_output(&c[4]);
+      fixture->output = std::move(output);
+      fixture->channel_count = 5;
+      break;
+    }
+    case FixtureType::CWWW: {
+      auto output = std::make_unique<CwWwXyOutput>();
+      output->set_profile(this->_cwww_profile);
+      output->set_cold_white_output(&c[0]);
+      output->set_warm_white_output(&c[1]);
+      fixture->output = std::move(output);
+      fixture->channel_count = 2;
+      break;
+    }
+    case FixtureType::WHITE: {
+      auto output = std::make_unique<WhiteXyOutput>();
+      output->set_profile(this->_white_profile);
+      output->set_white_output(&c[0]);
+      fixture->output = std::move(output);
+      fixture->channel_count = 1;
+      break;
+    }
+  }
+
+  fixture->output->set_bit_depth(this->_bit_depth);
+  fixture->light.add_output(fixture->output.get());
+
+  if (this->_check_frames) {
+    auto output = std::make_unique<WhiteXyOutput>();
+    output->set_profile(this->_white_profile);
+    output->set_white_output(&c[fixture->channel_count++]);
+    output->set_bit_depth(this->_bit_depth);
+    fixture->check_output = std::move(output);
+    fixture->light.add_output(fixture->check_output.get());
+
+    fixture->output->set_frame_sink(&fixture->sink);
+    fixture->check_output->set_frame_sink(&fixture->sink);
+  }
+
+  // In the same order as the light platform, so the worker hands its frames to the mailboxes
+  if (this->_async_write)
+    fixture->light.set_async_writer(&this->_async_writer);
+  if (this->_offload)
+    fixture->light.set_render_worker(&this->_render_worker);
+  fixture->control.set_xy_light_output(&fixture->light);
+  fixture->control.set_control_type(this->_control_type);
+  return fixture;
+}
+
+void XyLightSimulator::log_output_trace(uint32_t time_ms) {
+  auto &fixture = *this->_fixtures[0];
+
+  char line[96];
+  auto len = snprintf(line, sizeof(line), "%" PRIu32, time_ms);
+  for (uint8_t i = 0; i < fixture.channel_count && len > 0 && (size_t) len < sizeof(line); i++) {
+    len += snprintf(line + len, sizeof(line) - len, ",%.4f", fixture.channels[i].level);
+  }
+  ESP_LOGI(TAG, "trace,%s", line);
+}
+
+bool XyLightSimulator::settle_worker() {
+  auto start = millis();
+  while (true) {
+    // Both run every loop iteration on a device, so the writer can see the worker's frames part way through
+    this->_render_worker.loop();
+    if (this->_async_write)
+      this->_async_writer.loop();
+    if (this->_render_worker.settled())
+      return true;
+    if (millis() - start > WORKER_TIMEOUT_MS)
+      return false;
+    yield();
+  }
+}
+
+void XyLightSimulator::setup() {
+  if (this->_rgb_profile == nullptr) {
+    this->_default_rgb_profile.use_typical_led();
+    this->_rgb_profile = &this->_default_rgb_profile;
+  }
+  if (this->_cwww_profile == nullptr) {
+    this->_default_cwww_profile.set_cold_white_cct(154.0f);
+    this->_default_cwww_profile.set_warm_white_cct(370.0f);
+    this->_cwww_profile = &this->_default_cwww_profile;
+  }
+  if (this->_white_profile == nullptr) {
+    this->_default_white_profile.set_white_point_cct(250.0f);
+    this->_white_profile = &this->_default_white_profile;
+  }
+
+  if (this->_keyframes.empty() || this->_fixture_count == 0) {
+    ESP_LOGW(TAG, "Nothing to simulate");
+    return;
+  }
+
+  this->_fixtures.reserve(this->_fixture_count);
+  for (uint16_t i = 0; i < this->_fixture_count; i++) {
+    this->_fixtures.push_back(this->make_fixture());
+  }
+
+  if (this->_offload)
+    this->_render_worker.setup();
+
+  uint32_t end_ms = 0;
+  for (auto &keyframe : this->_keyframes) {
+    end_ms = std::max(end_ms, keyframe.time_ms + keyframe.transition_ms);
+  }
+
+  auto current = this->_keyframes[0].values;
+  auto from = current, to = current;
+  uint32_t transition_start = 0, transition_ms = 0;
+  size_t next = 0;
+
+  uint32_t frames = 0;
+  uint64_t total_us = 0;
+  uint32_t max_us = 0, first_us = 0;
+  uint32_t partial_frames = 0;
+
+  for (uint32_t t = 0; t <= end_ms; t += this->_frame_interval_ms) {
+    // Start the transition of any keyframe reached, from wherever the previous one has got to
+    while (next < this->_keyframes.size() && this->_keyframes[next].time_ms <= t) {
+      from = current;
+      to = this->_keyframes[next].values;
+      transition_start = this->_keyframes[next].time_ms;
+      transition_ms = this->_keyframes[next].transition_ms;
+      next++;
+    }
+
+    if (transition_ms == 0 || t >= transition_start + transition_ms) {
+      current = to;
+    } else {
+      current = light::LightColorValues::lerp(from, to, (float) (t - transition_start) / (float) transition_ms);
+    }
+
+    auto start = micros();
+    for (auto &fixture : this->_fixtures) {
+      fixture->control.write_color_values(current, this->_gamma_correct);
+    }
+    if (this->_offload && !this->settle_worker()) {
+      ESP_LOGE(TAG, "Render worker did not settle within %" PRIu32 " ms", WORKER_TIMEOUT_MS);
+      this->_render_worker.stop();
+      this->mark_failed();
+      return;
+    }
+    if (this->_async_write && !this->_offload)
+      this->_async_writer.loop();
+    auto elapsed = micros() - start;
+
+    // The first frame builds each fixture's lazily calculated tables, so is reported on its own
+    if (frames == 0) {
+      first_us = elapsed;
+    } else {
+      total_us += elapsed;
+      max_us = std::max(max_us, elapsed);
+    }
+    frames++;
+
+    if (this->_check_frames) {
+      for (auto &fixture : this->_fixtures) {
+        auto latches = fixture->sink.latches - fixture->checked_latches;
+        fixture->checked_latches = fixture->sink.latches;
+        if (fixture->sink.pending != 0 || latches > 1)
+          partial_frames++;
+      }
+    }
+
+    if (this->_output_trace)
+      this->log_output_trace(t);
+  }
+
+  if (this->_offload)
+    this->_render_worker.stop();
+
+  uint64_t writes = 0, suppressed_writes = 0;
+  for (auto &fixture : this->_fixtures) {
+    for (auto *channel : fixture->output->channels()) {
+      writes += channel->writes;
+      suppressed_writes += channel->suppressed_writes;
+    }
+  }
+
+  auto seconds = (float) (frames * this->_frame_interval_ms) / 1000.0f;
+  auto mean_us = frames > 1 ? (float) total_us / (float) (frames - 1) : (float) first_us;
+
+  ESP_LOGI(TAG, "Replayed %zu keyframes over %.1fs, %" PRIu32 " frames of %u fixtures%s%s", this->_keyframes.size(),
+           seconds, frames, this->_fixture_count, this->_offload ? ", offloaded" : "",
+           this->_async_write ? ", written asynchronously" : "");
+  ESP_LOGI(TAG, "  Frame latency: mean %.1f us, max %" PRIu32 " us, %.0f ns per fixture (first frame %" PRIu32 " us)",
+           mean_us, max_us, (mean_us * 1000.0f) / (float) this->_fixture_count, first_us);
+  ESP_LOGI(TAG, "  Frame budget used: %.1f%% of %" PRIu32 " ms", (mean_us / 10.0f) / (float) this->_frame_interval_ms,
+           this->_frame_interval_ms);
+  ESP_LOGI(TAG, "  Channel writes: %.0f/s, %.1f/s per fixture (%.1f%% suppressed as unchanged)",
+           (float) writes / seconds, (float) writes / seconds / (float) this->_fixture_count,
+           writes + suppressed_writes == 0 ? 0.0f : (100.0f * suppressed_writes) / (float) (writes + suppressed_writes));
+
+  if (this->_check_frames) {
+    uint32_t latches = 0;
+    for (auto &fixture : this->_fixtures) {
+      latches += fixture->sink.latches;
+    }
+    if (partial_frames != 0) {
+      ESP_LOGE(TAG, "  Frame check: %" PRIu32 " latches, %" PRIu32 " partial frames", latches, partial_frames);
+      this->mark_failed();
+    } else {
+      ESP_LOGI(TAG, "  Frame check: %" PRIu32 " latches, no partial frames", latches);
+    }
+  }
+}
+
+}  // namespace xy_light_simulator
+}  // namespace esphome
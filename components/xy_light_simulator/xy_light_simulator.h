@@ -0,0 +1,163 @@
+#pragma once
+#include <stdint.h>
+#include <memory>
+#include <vector>
+
+#include "esphome/core/component.h"
+#include "esphome/components/light/light_color_values.h"
+#include "esphome/components/output/float_output.h"
+#include "esphome/components/xy_light/xy_light.h"
+#include "esphome/components/xy_light/rgb_profile.h"
+#include "esphome/components/xy_light/cwww_profile.h"
+#include "esphome/components/xy_light/white_profile.h"
+
+namespace esphome {
+namespace xy_light_simulator {
+
+enum class FixtureType : uint8_t { RGB, RGBW, RGB_CWWW, CWWW, WHITE };
+
+// Stands in for a PWM channel, counting writes and keeping the last level
+class RecordingOutput : public output::FloatOutput {
+ public:
+  uint32_t writes = 0;
+  float level = 0.0f;
+
+ protected:
+  void write_state(float state) override {
+    this->writes++;
+    this->level = state;
+  }
+};
+
+// Stands in for a PWM chip with a synchronised update, driving all of a fixture's channels. Frames committed to it
+// only reach the recording outputs when it is latched, so they show what the fixture would, and a light which
+// latched part way through a render would leave frames waiting or latch more than once in a frame.
+class LatchingFrameSink : public xy_light::XyFrameSink {
+ public:
+  static const uint8_t MAX_FRAMES = 4;
+
+  uint32_t latches = 0;
+  // Frames committed since the last latch
+  uint8_t pending = 0;
+
+  void commit_frame(const xy_light::XyFrame &frame) override {
+    if (this->pending < MAX_FRAMES)
+      this->_frames[this->pending++] = frame;
+  }
+
+  void latch() override {
+    for (uint8_t i = 0; i < this->pending; i++) {
+      auto &frame = this->_frames[i];
+      for (uint8_t j = 0; j < frame.size; j++) {
+        frame.levels[j].channel->output->set_level(frame.levels[j].level);
+      }
+    }
+    this->pending = 0;
+    this->latches++;
+  }
+
+ protected:
+  xy_light::XyFrame _frames[MAX_FRAMES];
+};
+
+// Colour values the light is sent to at time_ms, reached over transition_ms from wherever it is at the time.
+// Effects are recorded as keyframes without a transition.
+struct Keyframe {
+  uint32_t time_ms;
+  uint32_t transition_ms;
+  light::LightColorValues values;
+};
+
+// One simulated light, wired the same way as the light platform wires a configured one
+struct Fixture {
+  // Up to 5 for the fixture's output, and one for the white output added when checking frames
+  static const uint8_t MAX_CHANNELS = 6;
+
+  std::unique_ptr<xy_light::XyOutput> output;
+  xy_light::XyLightOutput light;
+  xy_light::XyLightControl control;
+  RecordingOutput channels[MAX_CHANNELS];
+  uint8_t channel_count = 0;
+
+  // Only used when checking frames
+  std::unique_ptr<xy_light::XyOutput> check_output;
+  LatchingFrameSink sink;
+  uint32_t checked_latches = 0;
+};
+
+// Replays a recorded trace of light state changes through many simulated fixtures, without any hardware.
+// Reports frame latency and channel write rates, and optionally the levels of the first fixture for each frame.
+// Runs once from setup(), in simulated time (ie as fast as the host allows).
+//
+// When checking frames, each fixture gets a second (white) output, and both write through one latching sink. Every
+// frame must then reach the channels as a single latch of every output's levels, and the component is marked failed
+// if any partial frame could have been seen.
+//
+// The fixtures can also be rendered on a render worker and / or written through an async frame writer, wired the
+// same way as the light platform's offload and async_write options. The worker runs its own thread, and each frame
+// waits for it to render every fixture and for its frames to be committed and latched before the frame is checked.
+class XyLightSimulator : public Component {
+ public:
+  // Longest a frame waits for the render worker, before the simulation is abandoned
+  static const uint32_t WORKER_TIMEOUT_MS = 1000;
+
+ protected:
+  uint16_t _fixture_count = 1;
+  FixtureType _fixture_type = FixtureType::RGB_CWWW;
+  xy_light::ControlType _control_type = xy_light::ControlType::RGB_CT;
+  uint8_t _bit_depth = 12;
+  uint32_t _frame_interval_ms = 16;
+  float _gamma_correct = 2.8f;
+  bool _output_trace = false;
+  bool _check_frames = false;
+  bool _offload = false;
+  bool _async_write = false;
+
+  xy_light::RenderWorker _render_worker;
+  xy_light::AsyncFrameWriter _async_writer;
+
+  xy_light::RgbProfile *_rgb_profile = nullptr;
+  xy_light::CwWwProfile *_cwww_profile = nullptr;
+  xy_light::WhiteProfile *_white_profile = nullptr;
+
+  // Used for any profile which is not configured
+  xy_light::RgbProfile _default_rgb_profile;
+  xy_light::CwWwProfile _default_cwww_profile;
+  xy_light::WhiteProfile _default_white_profile;
+
+  std::vector<Keyframe> _keyframes;
+  std::vector<std::unique_ptr<Fixture>> _fixtures;
+
+  std::unique_ptr<Fixture> make_fixture();
+  void log_output_trace(uint32_t time_ms);
+  // Runs the worker's (and writer's) loop until it has rendered everything posted, false if it took over
+  // WORKER_TIMEOUT_MS
+  bool settle_worker();
+
+ public:
+  void set_fixture_count(uint16_t count) { this->_fixture_count = count; }
+  void set_fixture_type(FixtureType type) { this->_fixture_type = type; }
+  void set_control_type(xy_light::ControlType type) { this->_control_type = type; }
+  void set_bit_depth(uint8_t bit_depth) { this->_bit_depth = bit_depth; }
+  void set_frame_interval(uint32_t ms) { this->_frame_interval_ms = ms; }
+  void set_gamma_correct(float gamma) { this->_gamma_correct = gamma; }
+  void enable_output_trace(bool enable) { this->_output_trace = enable; }
+  void enable_check_frames(bool enable) { this->_check_frames = enable; }
+  void enable_offload(bool enable) { this->_offload = enable; }
+  void enable_async_write(bool enable) { this->_async_write = enable; }
+
+  void set_rgb_profile(xy_light::RgbProfile *profile) { this->_rgb_profile = profile; }
+  void set_cwww_profile(xy_light::CwWwProfile *profile) { this->_cwww_profile = profile; }
+  void set_white_profile(xy_light::WhiteProfile *profile) { this->_white_profile = profile; }
+
+  // Keyframes are expected in time order
+  void add_keyframe(uint32_t time_ms, uint32_t transition_ms, float state, float brightness, float red, float green,
+                    float blue, float color_temperature);
+
+  void setup() override;
+
+  float get_setup_priority() const override { return setup_priority::LATE; }
+};
+
+}  // namespace xy_light_simulator
+}  // namespace esphome